@@ -0,0 +1,261 @@
+#include "include/tools.h"
+
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Benchmark of the hash tables. Every configuration and catalog size runs in
+// its own process, so the peak memory of a run is not hidden by the previous
+// ones and a run over the time budget can be stopped. The results are written
+// to the standard output as CSV, one line per operation.
+
+struct BenchConfig {
+  // 0 -> Open; 1 -> Close; 2 -> Cuckoo
+  int hash;
+  int search_mode;
+  int disperse;
+  int exploration;
+  int auxiliar;
+  int block_size;
+};
+
+template<class Fd, class Fe>
+Table<Book>* NewBenchCloseTable(const BenchConfig& config, unsigned table_size) {
+  return new HashTable<Book, FlatSequence<Book>, Fd, Fe>(table_size, Fd(table_size), Fe(table_size), config.block_size);
+}
+
+template<class Fd>
+Table<Book>* NewBenchTable(const BenchConfig& config, unsigned table_size) {
+  if (config.hash == 0) return new HashTable<Book, DynamicSequence<Book>, Fd>(table_size, Fd(table_size));
+  if (config.hash == 2) return new HashTable<Book, CuckooSequence<Book>, Fd>(table_size, Fd(table_size), config.block_size);
+  switch (config.exploration) {
+    case 0: return NewBenchCloseTable<Fd, LinearFunction<Book>>(config, table_size);
+    case 1: return NewBenchCloseTable<Fd, QuadraticFunction<Book>>(config, table_size);
+    case 2:
+      switch (config.auxiliar) {
+        case 0: return NewBenchCloseTable<Fd, DoubleDisperseFunction<Book, ModFunction<Book>>>(config, table_size);
+        case 1: return NewBenchCloseTable<Fd, DoubleDisperseFunction<Book, SumFunction<Book>>>(config, table_size);
+        default: return NewBenchCloseTable<Fd, DoubleDisperseFunction<Book, RandFunction<Book>>>(config, table_size);
+      }
+    case 3: return NewBenchCloseTable<Fd, RedispersionFunction<Book>>(config, table_size);
+    default: return NewBenchCloseTable<Fd, RobinHoodFunction<Book>>(config, table_size);
+  }
+}
+
+/** @brief Creates the table of a configuration
+ *  @param[in] config. The configuration of the table.
+ *  @param[in] table_size. The initial number of blocks.
+ *  @return A pointer to the table created.
+ */
+Table<Book>* NewBenchTable(const BenchConfig& config, unsigned table_size) {
+  Table<Book>* table;
+  switch (config.disperse) {
+    case 0:  table = NewBenchTable<ModFunction<Book>>(config, table_size); break;
+    case 1:  table = NewBenchTable<SumFunction<Book>>(config, table_size); break;
+    default: table = NewBenchTable<RandFunction<Book>>(config, table_size); break;
+  }
+  table->SetKeyMode(config.search_mode);
+  table->SetSearchMode(config.search_mode);
+  return table;
+}
+
+/** @brief Writes the fields of a configuration and a size as the first columns of a line */
+void PrintConfig(const BenchConfig& config, size_t size) {
+  if (config.hash == 0)      std::printf("open,%d,%d,,,,%zu", config.search_mode, config.disperse, size);
+  else if (config.hash == 2) std::printf("cuckoo,%d,%d,,,%d,%zu", config.search_mode, config.disperse, config.block_size, size);
+  else                       std::printf("close,%d,%d,%d,%d,%d,%zu", config.search_mode, config.disperse, config.exploration, config.auxiliar, config.block_size, size);
+}
+
+/** @brief Times an operation over a whole catalog and writes its line
+ *  @param[in] config. The configuration of the table.
+ *  @param[in] size. The number of books of the catalog.
+ *  @param[in] name. The name of the operation.
+ *  @param[in] table. The table the operation works on, whose probes are counted.
+ *  @param[in] operation. The operation.
+ */
+template<class Operation>
+void Measure(const BenchConfig& config, size_t size, const char* name, const Table<Book>* table, Operation operation) {
+  uint64_t probes_before = table->Stats().probes;
+  auto start = std::chrono::steady_clock::now();
+  operation();
+  double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  double probes = double(table->Stats().probes - probes_before) / size;
+  PrintConfig(config, size);
+  std::printf(",%s,%.1f,%.3f,%ld\n", name, elapsed / size, probes, usage.ru_maxrss);
+  std::fflush(stdout);
+}
+
+/** @brief Runs every operation of the benchmark on a synthetic catalog
+ *  @param[in] config. The configuration of the table.
+ *  @param[in] size. The number of books of the catalog.
+ *  @param[in] table_size. The initial number of blocks of the tables.
+ */
+void RunBenchmark(const BenchConfig& config, size_t size, unsigned table_size) {
+  // The messages of the tables to std::cout would mix with the results
+  std::cout.setstate(std::ios::badbit);
+  std::vector<Book> catalog;
+  catalog.reserve(size);
+  constexpr Date start_date = Date::FromCivil(2024, 1, 1), return_date = Book::CalculateReturnDate(start_date);
+  for (size_t i = 0; i < size; ++i) {
+    Book& book = catalog.emplace_back("Title " + std::to_string(i), "Author " + std::to_string(i), double(i % 100), config.search_mode);
+    if (i % 10 == 0) book.AddReservation({ReaderName("Reader " + std::to_string(i)), start_date, return_date});
+  }
+  std::vector<std::string> missing(size);
+  for (size_t i = 0; i < size; ++i) missing[i] = "Missing " + std::to_string(i);
+  // The books are looked up in a different order than the one they are inserted in
+  std::vector<size_t> order(size);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(size));
+  std::string path = "/tmp/bench_" + std::to_string(getpid()) + ".dat";
+  int index;
+  size_t found = 0, deleted = 0;
+
+  Table<Book>* table = NewBenchTable(config, table_size);
+  Measure(config, size, "insert", table, [&] { for (const Book& book : catalog) table->Insert(book); });
+  Measure(config, size, "search_hit", table, [&] {
+    for (size_t i : order) found += table->Find(BookKey(catalog[i].GetName(), catalog[i].GetAuthor(), config.search_mode), index) != nullptr;
+  });
+  // The same lookups as search_hit, in batches whose cache misses overlap
+  Measure(config, size, "search_batch", table, [&] {
+    std::vector<BookKey> keys;
+    std::vector<Book*> results;
+    keys.reserve(size);
+    for (size_t i : order) keys.emplace_back(catalog[i].GetName(), catalog[i].GetAuthor(), config.search_mode);
+    table->SearchBatch(keys, results);
+    for (const Book* book : results) found += book != nullptr;
+  });
+  Measure(config, size, "search_miss", table, [&] {
+    for (size_t i : order) found += table->Find(BookKey(missing[i], missing[i], config.search_mode), index) != nullptr;
+  });
+  Measure(config, size, "save_file", table, [&] { std::ofstream out(path); table->SaveToFile(out); });
+  Measure(config, size, "delete", table, [&] {
+    for (size_t i : order) deleted += table->Delete(BookKey(catalog[i].GetName(), catalog[i].GetAuthor(), config.search_mode));
+  });
+  delete table;
+
+  table = NewBenchTable(config, table_size);
+  std::vector<Book> batch(catalog);
+  Measure(config, size, "insert_bulk", table, [&] { table->InsertBulk(std::move(batch)); });
+  delete table;
+
+  table = NewBenchTable(config, table_size);
+  Measure(config, size, "load_file", table, [&] { table->LoadFile(path); });
+  if (size_t(table->GetSize()) != size) std::fprintf(stderr, "load_file: %d books loaded of %zu\n", table->GetSize(), size);
+  // The secondary indexes are only built by the queries that need them, so their cost is measured apart
+  Measure(config, size, "build_indexes", table, [&] { table->BuildIndexes(); });
+  Measure(config, size, "delete_indexed", table, [&] {
+    for (size_t i : order) deleted += table->Delete(BookKey(catalog[i].GetName(), catalog[i].GetAuthor(), config.search_mode));
+  });
+  delete table;
+
+  table = NewBenchTable(config, table_size);
+  table->BuildIndexes();
+  Measure(config, size, "insert_indexed", table, [&] { for (const Book& book : catalog) table->Insert(book); });
+  delete table;
+  std::remove(path.c_str());
+  if (found != 2 * size || deleted != 2 * size) std::fprintf(stderr, "Found %zu books of %zu and deleted %zu of %zu\n", found, 2 * size, deleted, 2 * size);
+}
+
+/** @brief Reads the options of the benchmark. The options not given run every value.
+ *  @param[in] args. The arguments of the program.
+ *  @param[out] options. The value of every option given.
+ *  @return True if the options are correct, false otherwise.
+ */
+bool ReadOptions(const std::vector<std::string>& args, std::map<std::string, long>& options) {
+  for (size_t i = 1; i < args.size(); i += 2) {
+    const std::string& option = args[i];
+    if (option != "-sm" && option != "-fd" && option != "-hash" && option != "-fe" && option != "-aux" && option != "-bs" &&
+        option != "-ts" && option != "-min" && option != "-max" && option != "-budget") {
+      std::cerr << "./Bench: Invalid parameter " << option << std::endl;
+      return false;
+    }
+    if (i + 1 == args.size()) {
+      std::cerr << "./Bench: Missing value for " << option << std::endl;
+      return false;
+    }
+    if (option == "-hash") {
+      if (args[i + 1] != "open" && args[i + 1] != "close" && args[i + 1] != "cuckoo") {
+        std::cerr << "./Bench: Invalid value for " << option << std::endl;
+        return false;
+      }
+      options[option] = args[i + 1] == "open" ? 0 : args[i + 1] == "close" ? 1 : 2;
+      continue;
+    }
+    try {
+      options[option] = std::stol(args[i + 1]);
+    } catch (std::exception& error) {
+      std::cerr << "./Bench: Invalid value for " << option << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/** @brief Values of an option, the one given or every valid one */
+std::vector<int> OptionValues(const std::map<std::string, long>& options, const std::string& option, const std::vector<int>& all) {
+  if (options.find(option) == options.end()) return all;
+  return {int(options.at(option))};
+}
+
+// ./Bench [-sm <s>] [-fd <f>] [-hash <open|close|cuckoo>] [-fe <f>] [-aux <f>] [-bs <s>] [-ts <s>]
+//         [-min <size>] [-max <size>] [-budget <seconds>]
+int main(int argc, char* argv[]) {
+  std::map<std::string, long> options;
+  if (!ReadOptions(std::vector<std::string>(argv, argv + argc), options)) return 1;
+  auto option = [&options](const std::string& name, long value) { return options.count(name) ? options.at(name) : value; };
+  size_t min_size = option("-min", 1000), max_size = option("-max", 1000000);
+  unsigned table_size = option("-ts", 1009), budget = option("-budget", 60);
+
+  std::vector<BenchConfig> configs;
+  for (int search_mode : OptionValues(options, "-sm", {0, 1, 2})) {
+    for (int disperse : OptionValues(options, "-fd", {0, 1, 2})) {
+      for (int hash : OptionValues(options, "-hash", {0, 1, 2})) {
+        if (hash == 0) {
+          configs.push_back({0, search_mode, disperse, 0, 0, 1});
+          continue;
+        }
+        if (hash == 2) {
+          for (int block_size : OptionValues(options, "-bs", {1, 3, 8})) {
+            configs.push_back({2, search_mode, disperse, 0, 0, block_size});
+          }
+          continue;
+        }
+        for (int exploration : OptionValues(options, "-fe", {0, 1, 2, 3, 4})) {
+          for (int auxiliar : exploration == 2 ? OptionValues(options, "-aux", {0, 1, 2}) : std::vector<int>{0}) {
+            for (int block_size : OptionValues(options, "-bs", {1, 3, 8})) {
+              configs.push_back({1, search_mode, disperse, exploration, auxiliar, block_size});
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::printf("hash,sm,fd,fe,aux,bs,size,operation,ns_per_op,probes_per_op,peak_rss_kb\n");
+  for (const BenchConfig& config : configs) {
+    for (size_t size = min_size; size <= max_size; size *= 10) {
+      std::fflush(stdout);
+      pid_t child = fork();
+      if (child == 0) {
+        alarm(budget);
+        RunBenchmark(config, size, table_size);
+        std::fflush(stdout);
+        _exit(0);
+      }
+      int status;
+      waitpid(child, &status, 0);
+      // The bigger catalogs of a configuration over the budget are not run
+      if (!WIFEXITED(status)) {
+        PrintConfig(config, size);
+        std::printf(",%s,,,\n", WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM ? "timeout" : "crash");
+        break;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,49 @@
+#include "include/tools.h"
+
+// Tests of the disperse functions of the tables. It exits with 1 if a check
+// fails.
+
+/** @brief Writes the result of a check and counts it if it fails
+ *  @param[in] passed. Whether the check has passed.
+ *  @param[in] name. What the check verifies.
+ *  @param[in,out] failed. The number of checks failed.
+ */
+void Check(bool passed, const std::string& name, int& failed) {
+  std::cout << (passed ? "ok   " : "FAIL ") << name << std::endl;
+  if (!passed) ++failed;
+}
+
+/** @brief Counts the blocks of a table that hold a key */
+template<class Key>
+int CountUsedBlocks(const Table<Key>& table) {
+  int used = 0;
+  for (int block = 0; block < table.GetTableSize(); ++block) {
+    bool holds_key = false;
+    table.ForEachInBlock(block, [&](const Key&) { holds_key = true; });
+    if (holds_key) ++used;
+  }
+  return used;
+}
+
+/** @brief Inserts 10000 books in an open table dispersed by the sum of the
+ *         digits of their hash, which grows over a thousand blocks: the books
+ *         must be spread over many more blocks than the 181 sums of the digits
+ *         of a 64 bit number.
+ *  @param[in,out] failed. The number of checks failed.
+ */
+void TestSumFunctionSpread(int& failed) {
+  const int kBooks = 10000;
+  HashTable<Book, DynamicSequence<Book>, SumFunction<Book>> table(101, SumFunction<Book>(101));
+  table.SetKeyMode(0);
+  table.SetSearchMode(0);
+  for (int i = 0; i < kBooks; ++i) table.Insert(Book("Title " + std::to_string(i), "Author " + std::to_string(i), 1, 0));
+  Check(table.GetSize() == kBooks, "every book inserted", failed);
+  int used = CountUsedBlocks(table);
+  Check(used > table.GetTableSize() / 2, "books spread over the table (" + std::to_string(used) + " blocks used of " + std::to_string(table.GetTableSize()) + ")", failed);
+}
+
+int main() {
+  int failed = 0;
+  TestSumFunctionSpread(failed);
+  return failed == 0 ? 0 : 1;
+}
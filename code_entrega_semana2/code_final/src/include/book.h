@@ -2,85 +2,104 @@
 #define BOOK_H
 
 #include "tools.h"
-#include <list>
+#include "string_hash.h"
+#include "reservation.h"
+#include "string_arena.h"
+#include <string_view>
 //#include "hashtable.h"
 
-  // Estructura para representar una reserva de libro
-struct Reservation {
-    std::string name;
-    std::string startDate;
-    std::string returnDate;
+/** @brief Computes the hash of a book from the fields of a search mode
+ *  @param[in] name. The name of the book.
+ *  @param[in] author. The author of the book.
+ *  @param[in] search_mode. 0 -> Name; 1 -> Author; 2 -> Both.
+ *  @param[in] seed. The seed of the hash.
+ *  @return The hash of the book.
+ */
+inline HashValue BookHash(std::string_view name, std::string_view author, int search_mode, HashValue seed) {
+  switch (search_mode) {
+    case 0:  return StringHash(name, seed);
+    case 1:  return StringHash(author, seed);
+    default: return StringHash(author, StringHash(name, seed));
+  }
+}
+
+// Lookup key of a book. It only views the name and author it searches for, so
+// the table can be queried without building a Book.
+struct BookKey {
+  BookKey(std::string_view name, std::string_view author, int search_mode);
+  BookKey(HashValue hash, std::string_view name, std::string_view author, int search_mode) 
+      : name(name), author(author), search_mode(search_mode), hash(hash) {}
+  operator HashValue() const { return hash; }
+  std::string_view name;
+  std::string_view author;
+  int search_mode;
+  HashValue hash;
 };
 
 class Book {
  public:
+  // Type used to search the books of a table without building one
+  typedef BookKey View;
   Book() : default_(true) {}
-  Book(const std::string& name, const std::string& author, const double& price, const int& search_mode) : name_(name), author_(author), price_(price) {
-    switch (search_mode) {
-      case 0:
-        for (auto& i : name_) hash_number_ += i;
-        break;
-      case 1:
-        for (auto& i : author_) hash_number_ += i;
-        break;
-      case 2:
-        for (auto& i : name_) hash_number_ += i;
-        for (auto& i : author_) hash_number_ += i;
-        break;
+  Book(std::string_view name, std::string_view author, const double& price, const int& search_mode) 
+      : strings_(name, author), price_(price), search_mode_(search_mode) {
+    // The hash is computed once here and reused by every disperse and exploration function
+    hash_number_ = BookHash(name, author, search_mode, hash_seed_);
+  }
+  // Builds a book whose hash is already known, as the ones read from a snapshot
+  Book(std::string_view name, std::string_view author, const double& price, const int& search_mode, HashValue hash) 
+      : strings_(name, author), price_(price), search_mode_(search_mode), hash_number_(hash) {}
+  // Copies a book whose name and author are stored in an arena, as the books of a table
+  Book(const Book& book, StringArena& arena) 
+      : default_(book.default_), strings_(book.strings_, arena), price_(book.price_), search_mode_(book.search_mode_), 
+        hash_number_(book.hash_number_), returnDate_(book.returnDate_), book_reservations_(book.book_reservations_) {}
+  Book(const Book& book) = default;
+  Book(Book&& book) = default;
+  Book& operator=(const Book& book) = default;
+  Book& operator=(Book&& book) = default;
+  // Two books are the same if the fields of the search mode are equal
+  bool operator==(const Book& book) const {
+    if (hash_number_ != book.hash_number_) return false;
+    switch (search_mode_) {
+      case 0:  return GetName() == book.GetName();
+      case 1:  return GetAuthor() == book.GetAuthor();
+      default: return GetName() == book.GetName() && GetAuthor() == book.GetAuthor();
+    }
+  }
+  bool operator==(const BookKey& key) const {
+    if (hash_number_ != key.hash) return false;
+    switch (key.search_mode) {
+      case 0:  return GetName() == key.name;
+      case 1:  return GetAuthor() == key.author;
+      default: return GetName() == key.name && GetAuthor() == key.author;
     }
   }
-  bool operator==(const Book& book) const { return name_ == std::string(book); }
-  operator long() const { return hash_number_; }
-  operator std::string() const { return name_ + ", " + author_ + " -> " + std::to_string(price_) + "€"; }
+  operator HashValue() const { return hash_number_; }
+  // Changes the seed of the hash of the books created from now on
+  static void SetHashSeed(HashValue seed) { hash_seed_ = seed; }
+  static HashValue GetHashSeed() { return hash_seed_; }
+  operator std::string() const { return std::string(GetName()) + ", " + std::string(GetAuthor()) + " -> " + std::to_string(price_) + "€"; }
   bool IsDefault() const { return default_; }
-  std::string GetName() const { return name_; }
-  std::string GetAuthor() const { return author_; }
+  std::string_view GetName() const { return strings_.Name(); }
+  std::string_view GetAuthor() const { return strings_.Author(); }
+  // Moves the name and the author to an arena, which must live as long as the book
+  void StoreIn(StringArena& arena) { strings_.StoreIn(arena); }
   double GetPrice() const { return price_; }
-  std::string GetReturnDate() const { return returnDate_; }
-  std::list<Reservation> GetReservations() const { return book_reservations_; }
+  Date GetReturnDate() const { return returnDate_; }
+  const ReservationList& GetReservations() const { return book_reservations_; }
   void AddReservation(const Reservation& reservation) { book_reservations_.push_back(reservation); }
-// Función para obtener la fecha de tres dias a partir de hoy en formato día-mes-año
-  std::string GetDate() {
-    std::time_t now = std::time(nullptr);
-    std::tm* localTime = std::localtime(&now);
-    
-    int day = localTime->tm_mday + 3;
-    int month = localTime->tm_mon + 1;
-    int year = localTime->tm_year + 1900;
+// Función para obtener la fecha de tres dias a partir de hoy
+  static Date GetDate() { return Date::Today() + kDaysToPickUp; }
 
-    std::stringstream dateStream;
-    dateStream << std::setfill('0') << std::setw(2) << day << "/" << std::setw(2) << month << "/" << year;
-
-    return dateStream.str();
-  }
-
-  std::string GetOriginalDate(std::string return_date) {
-    std::tm tm = {};
-    std::istringstream ss(return_date);
-    ss >> std::get_time(&tm, "%d/%m/%Y");
-    std::time_t time = std::mktime(&tm);
-    time -= 30 * 24 * 60 * 60; // Resta 30 días (1 mes)
-    tm = *std::localtime(&time);
-    char buffer[11];
-    std::strftime(buffer, sizeof(buffer), "%d/%m/%Y", &tm);
-    return std::string(buffer);
-  }
+  // Fecha de inicio de una reserva a partir de su fecha de devolución
+  static constexpr Date GetOriginalDate(Date return_date) { return return_date - kLoanDays; }
 
   // Función para calcular la fecha de devolución (1 mes después de la fecha de inicio)
-  std::string CalculateReturnDate(const std::string& startDate) {
-    std::tm tm = {};
-    std::istringstream ss(startDate);
-    ss >> std::get_time(&tm, "%d/%m/%Y");
-    std::time_t time = std::mktime(&tm);
-    time += 30 * 24 * 60 * 60; // Agrega 30 días (1 mes)
-    tm = *std::localtime(&time);
-    char buffer[11];
-    std::strftime(buffer, sizeof(buffer), "%d/%m/%Y", &tm);
-    return std::string(buffer);
-  }
+  static constexpr Date CalculateReturnDate(Date start_date) { return start_date + kLoanDays; }
 
   bool FindPreviousReservation(const Reservation& reservation, Reservation& previousReservation) {
     for (const Reservation& res : book_reservations_) {
+      // The names are interned, so equal names have equal handles
       if (!res.name.empty() && res.name == reservation.name) {
         previousReservation = res;
         return true;
@@ -89,34 +108,35 @@ class Book {
     return false;
   }
 
-  void MakeReservation(Reservation& reservation) {
-    std::string todayDate = GetDate();
-    std::string name;
-    std::cout << "Introduce the name of the person who will make the reservation: ";
-    std::cin.ignore();
-    std::getline(std::cin, name);
-    reservation.name = name;
-    reservation.startDate = todayDate;
-    reservation.returnDate = CalculateReturnDate(todayDate);
+  // Reserves the book for a person from today, or from the end of the previous reservation of the person
+  Reservation Reserve(const std::string& name) {
+    Reservation reservation;
+    reservation.name = ReaderName(name);
+    reservation.start_date = GetDate();
     Reservation previous_reservation;
     if (FindPreviousReservation(reservation, previous_reservation)) {
-      reservation.startDate = previous_reservation.returnDate;
-      reservation.returnDate = CalculateReturnDate(reservation.startDate);
-      std::cout << "Nueva reserva para: " << name_ << ".  Con fecha: "  << reservation.startDate << " - " << reservation.returnDate << std::endl;
-    } 
-    else {
-      reservation.returnDate = CalculateReturnDate(reservation.startDate);
-      std::cout << "Nueva reserva para: " << name_ << ".  Con fecha: "  << reservation.startDate << " - " << reservation.returnDate << std::endl;
+      reservation.start_date = previous_reservation.return_date;
     }
+    reservation.return_date = CalculateReturnDate(reservation.start_date);
     // Agregar la reserva al mapa de reservas de libros
     book_reservations_.push_back(reservation);
+    return reservation;
+  }
+
+  void MakeReservation(Reservation& reservation) {
+    std::string name;
+    std::cout << "Introduce the name of the person who will make the reservation: ";
+    std::cin.ignore();
+    std::getline(std::cin, name);
+    reservation = Reserve(name);
+    std::cout << "Nueva reserva para: " << GetName() << ".  Con fecha: "  << reservation.start_date << " - " << reservation.return_date << std::endl;
   }
 
   void ShowReservations(const std::string& name_) {
     std::cout << "Reservas para el libro '" << name_ << "':" << std::endl;
     if (book_reservations_.size() > 0) {
       for (const Reservation& reservation : book_reservations_) {
-        std::cout << "Fecha de inicio: " << reservation.startDate << " | Fecha de retorno: " << reservation.returnDate << std::endl;
+        std::cout << "Fecha de inicio: " << reservation.start_date << " | Fecha de retorno: " << reservation.return_date << std::endl;
       }
     } 
     else {
@@ -125,22 +145,30 @@ class Book {
 }
 
   //Modifica fecha de retorno
-  void ModifyReturnDate(const std::string& newReturnDate) {
-    if (newReturnDate > returnDate_){
-      returnDate_ = newReturnDate;
+  // The new date must be a valid date after the current one, compared as dates instead of as text
+  bool ModifyReturnDate(const std::string& newReturnDate) {
+    Date date;
+    if (Date::Parse(newReturnDate, date) && date > returnDate_){
+      returnDate_ = date;
+      return true;
     } else {
       std::cout << "Fecha introducida no válida\n" << std::endl;
+      return false;
     }
   }
 
  private:
   bool default_ = false;
-  std::string name_;
-  std::string author_;
+  BookStrings strings_;
   double price_ = 0.0;
-  long hash_number_ = 0;
-  std::string returnDate_;
-  std::list<Reservation> book_reservations_;
+  int search_mode_ = 0;
+  HashValue hash_number_ = 0;
+  inline static HashValue hash_seed_ = kDefaultHashSeed;
+  Date returnDate_;
+  ReservationList book_reservations_;
 };
 
+inline BookKey::BookKey(std::string_view name, std::string_view author, int search_mode) 
+    : name(name), author(author), search_mode(search_mode), hash(BookHash(name, author, search_mode, Book::GetHashSeed())) {}
+
 #endif
\ No newline at end of file
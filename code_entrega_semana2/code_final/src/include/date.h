@@ -0,0 +1,162 @@
+#ifndef DATE_H
+#define DATE_H
+
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Dates of the reservations. A date is a number of days, so adding days to it
+// is an addition, and it is converted from and to the day, month and year of
+// the calendar with integer arithmetic instead of the <ctime> functions. The
+// dates are written as dd/mm/yyyy.
+
+// Number of characters of a date written as dd/mm/yyyy
+const size_t kDateLength = 10;
+
+class Date {
+ public:
+  // Number of days of a date that can't be read, before every valid date
+  static constexpr int32_t kInvalidDays = INT32_MIN;
+  constexpr Date() : days_(kInvalidDays) {}
+  constexpr explicit Date(int32_t days) : days_(days) {}
+  static constexpr Date FromCivil(int year, unsigned month, unsigned day);
+  static bool Parse(std::string_view text, Date& date);
+  static Date Today();
+  constexpr void ToCivil(int& year, unsigned& month, unsigned& day) const;
+  char* Format(char* buffer) const;
+  std::string ToString() const;
+  // Number of days since 01/01/1970
+  constexpr int32_t Days() const { return days_; }
+  constexpr bool IsValid() const { return days_ != kInvalidDays; }
+  constexpr Date operator+(int32_t days) const { return Date(days_ + days); }
+  constexpr Date operator-(int32_t days) const { return Date(days_ - days); }
+  constexpr bool operator==(const Date& date) const { return days_ == date.days_; }
+  constexpr bool operator!=(const Date& date) const { return days_ != date.days_; }
+  constexpr bool operator<(const Date& date) const { return days_ < date.days_; }
+  constexpr bool operator>(const Date& date) const { return days_ > date.days_; }
+ private:
+  int32_t days_;
+};
+
+/** @brief Checks if a year of the Gregorian calendar is a leap year */
+constexpr bool IsLeapYear(int year) { return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0); }
+
+/** @brief Number of days of a month of a year */
+constexpr unsigned DaysInMonth(int year, unsigned month) {
+  return month == 2 ? (IsLeapYear(year) ? 29 : 28) : (month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31;
+}
+
+/** @brief Builds a date from its day, month and year. The years are counted
+ *         from March, so the leap day is the last day of a year, and split in
+ *         eras of 400 years, which all have the same number of days.
+ *  @param[in] year. The year.
+ *  @param[in] month. The month, from 1 to 12.
+ *  @param[in] day. The day of the month, from 1.
+ *  @return The date.
+ */
+constexpr Date Date::FromCivil(int year, unsigned month, unsigned day) {
+  year -= month <= 2;
+  int era = (year >= 0 ? year : year - 399) / 400;
+  unsigned year_of_era = unsigned(year - era * 400);
+  unsigned day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  // 719468 is the number of days from 01/03/0000 to 01/01/1970
+  return Date(int32_t(era * 146097 + int(day_of_era) - 719468));
+}
+
+/** @brief Gets the day, month and year of the date, the inverse of FromCivil()
+ *  @param[out] year. The year.
+ *  @param[out] month. The month, from 1 to 12.
+ *  @param[out] day. The day of the month, from 1.
+ */
+constexpr void Date::ToCivil(int& year, unsigned& month, unsigned& day) const {
+  int days = days_ + 719468;
+  int era = (days >= 0 ? days : days - 146096) / 146097;
+  unsigned day_of_era = unsigned(days - era * 146097);
+  unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+  unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  unsigned month_from_march = (5 * day_of_year + 2) / 153;
+  day = day_of_year - (153 * month_from_march + 2) / 5 + 1;
+  month = month_from_march < 10 ? month_from_march + 3 : month_from_march - 9;
+  year = int(year_of_era) + era * 400 + (month <= 2);
+}
+
+/** @brief Reads a number of at most some digits from the beginning of a text
+ *  @param[in,out] text. The text, which loses the digits read.
+ *  @param[in] max_digits. The maximum number of digits.
+ *  @param[out] number. The number read.
+ *  @return True if the text starts with a digit, false otherwise.
+ */
+inline bool ParseDateField(std::string_view& text, size_t max_digits, unsigned& number) {
+  size_t digits = 0;
+  number = 0;
+  while (digits < max_digits && digits < text.size() && text[digits] >= '0' && text[digits] <= '9') {
+    number = number * 10 + unsigned(text[digits] - '0');
+    ++digits;
+  }
+  text.remove_prefix(digits);
+  return digits > 0;
+}
+
+/** @brief Reads a date written as dd/mm/yyyy. The day and the month may have a
+ *         single digit, and the day must exist in the month.
+ *  @param[in] text. The date.
+ *  @param[out] date. The date read.
+ *  @return True if the whole text is a valid date, false otherwise.
+ */
+inline bool Date::Parse(std::string_view text, Date& date) {
+  unsigned day, month, year;
+  if (!ParseDateField(text, 2, day) || text.empty() || text.front() != '/') return false;
+  text.remove_prefix(1);
+  if (!ParseDateField(text, 2, month) || text.empty() || text.front() != '/') return false;
+  text.remove_prefix(1);
+  if (!ParseDateField(text, 4, year) || !text.empty()) return false;
+  if (month < 1 || month > 12 || day < 1 || day > DaysInMonth(year, month)) return false;
+  date = FromCivil(year, month, day);
+  return true;
+}
+
+/** @brief Gets the date of today in the local time zone */
+inline Date Date::Today() {
+  std::time_t now = std::time(nullptr);
+  std::tm local_time;
+  localtime_r(&now, &local_time);
+  return FromCivil(local_time.tm_year + 1900, local_time.tm_mon + 1, local_time.tm_mday);
+}
+
+/** @brief Writes the date as dd/mm/yyyy. The years after 9999 are not written
+ *         whole, as they don't fit in four digits.
+ *  @param[in] buffer. The buffer, of at least kDateLength characters.
+ *  @return The end of the date written, kDateLength characters after the buffer.
+ */
+inline char* Date::Format(char* buffer) const {
+  int year = 0;
+  unsigned month = 0, day = 0;
+  ToCivil(year, month, day);
+  unsigned fields[] = {day / 10, day % 10, month / 10, month % 10,
+                       unsigned(year) / 1000 % 10, unsigned(year) / 100 % 10, unsigned(year) / 10 % 10, unsigned(year) % 10};
+  const char* layout = "dd/mm/yyyy";
+  for (size_t i = 0, field = 0; i < kDateLength; ++i) {
+    buffer[i] = layout[i] == '/' ? '/' : char('0' + fields[field++]);
+  }
+  return buffer + kDateLength;
+}
+
+/** @brief Writes the date as dd/mm/yyyy
+ *  @return The date, empty if it is not valid.
+ */
+inline std::string Date::ToString() const {
+  if (!IsValid()) return std::string();
+  char buffer[kDateLength];
+  return std::string(buffer, Format(buffer));
+}
+
+inline std::ostream& operator<<(std::ostream& out, const Date& date) {
+  if (!date.IsValid()) return out;
+  char buffer[kDateLength];
+  return out.write(buffer, date.Format(buffer) - buffer);
+}
+
+#endif
@@ -3,12 +3,48 @@
 
 #include "tools.h"
 
+/** @brief Gets the smallest prime number greater or equal than a given one.
+ *         Tables grow to prime sizes so quadratic and double dispersion
+ *         exploration keep visiting different blocks.
+ *  @param[in] number. The lower bound.
+ *  @return The prime number.
+ */
+inline unsigned NextPrime(unsigned number) {
+  if (number < 2) return 2;
+  for (;; ++number) {
+    bool prime = true;
+    for (unsigned i = 2; i * i <= number; ++i) {
+      if (number % i == 0) { prime = false; break; }
+    }
+    if (prime) return number;
+  }
+}
+
+/** @brief Counter based pseudo-random generator. The n-th number of the
+ *         sequence of a key is computed directly by scrambling the key and the
+ *         counter, so it uses no shared state: it is reentrant and gives the
+ *         same numbers for a key in any thread.
+ *  @param[in] key. The hash of the key that selects the sequence.
+ *  @param[in] counter. The position of the number in the sequence.
+ *  @return The pseudo-random number.
+ */
+inline HashValue RandomAt(HashValue key, HashValue counter) {
+  HashValue z = key + (counter + 1) * 0x9e3779b97f4a7c15ull;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+// The disperse and exploration functions are policies of the HashTable: they
+// are not virtual, so the table calls them directly and the compiler can
+// inline them in the probe loops. They accept anything that converts to a
+// HashValue, so a key can be dispersed from a lookup view or a bare hash.
+
 template <class Key>
 class DisperseFunction {
  public:
   DisperseFunction(unsigned table_size) : table_size_(table_size) {}
-  virtual ~DisperseFunction() {}
-  virtual unsigned operator()(const Key& key) const = 0;
+  void Resize(unsigned table_size) { table_size_ = table_size; }
  protected:
   int table_size_;
 };
@@ -17,20 +53,29 @@ template <class Key>
 class ModFunction : public DisperseFunction<Key> {
  public:
   ModFunction(unsigned table_size) : DisperseFunction<Key>(table_size) {}
-  unsigned operator()(const Key& key) const { return long(key) % this->table_size_; }
+  template<class K> unsigned operator()(const K& key) const { return HashValue(key) % this->table_size_; }
 };
 
+/** @brief Sums the decimal digits of a number
+ *  @param[in] number. The number.
+ *  @return The sum of its digits.
+ */
+inline unsigned DigitSum(HashValue number) {
+  unsigned summatory = 0;
+  for (; number != 0; number /= 10) summatory += number % 10;
+  return summatory;
+}
+
 template <class Key>
 class SumFunction : public DisperseFunction<Key> {
  public:
   SumFunction(unsigned table_size) : DisperseFunction<Key>(table_size) {}
-  unsigned operator()(const Key& key) const {
-    unsigned copy_key = long(key), summatory = 0;
-    while (copy_key != 0) {
-      summatory += copy_key % 10;
-      copy_key /= 10;
-    }
-    return summatory % this->table_size_;
+  // The digit sum of a hash is at most 180, so the sums of its two halves are
+  // mixed back into the whole hash to reach every block of a bigger table
+  template<class K> unsigned operator()(const K& key) const {
+    HashValue hash = HashValue(key);
+    HashValue sums = (HashValue(DigitSum(hash >> 32)) << 32) | DigitSum(hash & 0xffffffffu);
+    return HashMix(hash ^ kHashPrime2, sums ^ kHashPrime3) % this->table_size_;
   }
 };
 
@@ -38,15 +83,15 @@ template <class Key>
 class RandFunction : public DisperseFunction<Key> {
  public:
   RandFunction(unsigned table_size) : DisperseFunction<Key>(table_size) {}
-  unsigned operator()(const Key& key) const { srand(long(key)); return rand() % this->table_size_; }
+  // The operator returns the first random number of the sequence of the key
+  template<class K> unsigned operator()(const K& key) const { return RandomAt(HashValue(key), 0) % this->table_size_; }
 };
 
 template <class Key>
 class ExplorationFunction {
  public:
   ExplorationFunction(unsigned table_size) : table_size_(table_size) {}
-  virtual ~ExplorationFunction() {}
-  virtual unsigned operator()(const Key& key, unsigned attempt) const = 0;
+  void Resize(unsigned table_size) { table_size_ = table_size; }
  protected:
   int table_size_;
 };
@@ -56,7 +101,7 @@ class LinearFunction : public ExplorationFunction<Key> {
  public:
   LinearFunction(unsigned table_size) : ExplorationFunction<Key>(table_size) {}
   // The operator simply returns the attempt as a new position
-  unsigned operator()(const Key& key, unsigned attempt) const { return attempt; }
+  template<class K> unsigned operator()(const K& /*key*/, unsigned attempt) const { return attempt; }
 };
 
 template <class Key>
@@ -64,33 +109,34 @@ class QuadraticFunction : public ExplorationFunction<Key> {
  public:
   QuadraticFunction(unsigned table_size) : ExplorationFunction<Key>(table_size) {}
   // The operator returns a position based by the attempt squared
-  unsigned operator()(const Key& key, unsigned attempt) const { return attempt * attempt; }
+  template<class K> unsigned operator()(const K& /*key*/, unsigned attempt) const { return attempt * attempt; }
 };
 
-template <class Key>
+template <class Key, class AuxiliarFunction = ModFunction<Key>>
 class DoubleDisperseFunction : public ExplorationFunction<Key> {
  public:
-  DoubleDisperseFunction(unsigned table_size, DisperseFunction<Key>* fd) : ExplorationFunction<Key>(table_size) { fd_ = fd; }
-  virtual ~DoubleDisperseFunction() { delete fd_; }
+  DoubleDisperseFunction(unsigned table_size) : ExplorationFunction<Key>(table_size), fd_(table_size) {}
+  void Resize(unsigned table_size) { this->table_size_ = table_size; fd_.Resize(table_size); }
   // The operator uses a disperse function to get a new position by multiplying it to attempt
-  unsigned operator()(const Key& key, unsigned attempt) const { return attempt * (*fd_)(key); }
+  template<class K> unsigned operator()(const K& key, unsigned attempt) const { return attempt * fd_(key); }
  private:
-  DisperseFunction<Key>* fd_;
+  AuxiliarFunction fd_;
 };
 
 template <class Key>
 class RedispersionFunction : public ExplorationFunction<Key> {
  public:
   RedispersionFunction(unsigned table_size) : ExplorationFunction<Key>(table_size) {}
-  // The operator uses a random function that iterates attempt times to get a new position
-  unsigned operator()(const Key& key, unsigned attempt) const { 
-    srand(long(key));
-    if (attempt == 1) return rand();
-    for (unsigned i = 0; i < attempt - 2; ++i) {
-      rand();
-    }
-    return rand();
-  }
+  // The operator returns the attempt-th random number of the sequence of the key as a new position
+  template<class K> unsigned operator()(const K& key, unsigned attempt) const { return RandomAt(HashValue(key), attempt) % this->table_size_; }
+};
+
+template <class Key>
+class RobinHoodFunction : public ExplorationFunction<Key> {
+ public:
+  RobinHoodFunction(unsigned table_size) : ExplorationFunction<Key>(table_size) {}
+  // The operator explores linearly, the table moves the keys along the sequence to keep them close to their home
+  template<class K> unsigned operator()(const K& /*key*/, unsigned attempt) const { return attempt; }
 };
 
 #endif
\ No newline at end of file
@@ -3,56 +3,355 @@
 
 #include "tools.h"
 #include "sequence.h"
+#include "secondary_index.h"
+#include "snapshot.h"
+#include "string_arena.h"
+#include "text_loader.h"
+#include "title_index.h"
+
+// Load factor over which the tables grow if none is specified
+const double kDefaultMaxLoadFactor = 0.75;
+// Ratio of the slots of a closed table deleted since it was last rebuilt over
+// which it is rebuilt to clean up the tombstones left in the probe chains
+const double kMaxDeletedFactor = 0.25;
+// Number of keys of a batch whose memory accesses are overlapped
+const size_t kBatchGroupSize = 16;
+// Number of probe lengths counted apart, the last one counts the longer probes too
+const int kProbeHistogramSize = 16;
+// Number of bytes Table::Write gathers before writing them to the stream
+const size_t kWriteBufferSize = 1 << 16;
+// Distance of the slots of a Robin Hood table without a key
+const unsigned kNoDistance = UINT_MAX;
+// Number of keys a cuckoo table keeps apart when no displacement path frees a slot for them
+const size_t kCuckooStashSize = 4;
+// Number of blocks the search of a displacement path of a cuckoo table visits at most
+const size_t kMaxCuckooSearch = 64;
+// Load factor under which a cuckoo table that finds no room for a key draws the
+// alternate blocks again instead of growing, as its disperse function is what keeps the key out
+const double kMinCuckooLoadFactor = 0.25;
+// Number of times a cuckoo table is rebuilt with a new seed before it grows
+// anyway, as a disperse function that crowds the keys in a few blocks leaves
+// more keys than the stash holds out of them with any alternate blocks
+const int kMaxCuckooReseeds = 3;
+// Number of times a cuckoo table is rebuilt to make room for a key before the key is rejected
+const int kMaxCuckooRebuilds = 8;
+
+// Blocks written by Table::Write
+struct WriteOptions {
+  unsigned first_block = 0;
+  // One past the last block written, past the end of the table to write up to the end
+  unsigned last_block = UINT_MAX;
+  // Skips the blocks without keys
+  bool non_empty_only = false;
+};
+
+// Counters of the operations of a table. The length of a probe is the number
+// of blocks visited to find or place a key.
+struct TableStats {
+  uint64_t inserts = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t probes = 0;
+  uint64_t max_probe = 0;
+  // Blocks found full by the insertions, each one a collision
+  uint64_t full_blocks = 0;
+  // Probe sequences that ended without a free block or the key searched
+  uint64_t exhausted = 0;
+  uint64_t probe_lengths[kProbeHistogramSize] = {};
+  void RecordProbe(uint64_t length) {
+    probes += length;
+    max_probe = std::max(max_probe, length);
+    ++probe_lengths[std::min<uint64_t>(length, kProbeHistogramSize) - 1];
+  }
+  void RecordLookup(bool found, uint64_t length) {
+    ++(found ? hits : misses);
+    RecordProbe(length);
+  }
+  void RecordInsert(uint64_t length) {
+    ++inserts;
+    full_blocks += length - 1;
+    RecordProbe(length);
+  }
+};
+
+/** @brief Writes the counters of a table, one per line
+ *  @param[in] out. The output stream.
+ *  @param[in] stats. The counters.
+ *  @return The output stream.
+ */
+inline std::ostream& operator<<(std::ostream& out, const TableStats& stats) {
+  uint64_t operations = stats.inserts + stats.hits + stats.misses;
+  out << "inserts: " << stats.inserts << "\n"
+      << "hits: " << stats.hits << "\n"
+      << "misses: " << stats.misses << "\n"
+      << "probes: " << stats.probes << "\n"
+      << "probes per operation: " << (operations == 0 ? 0.0 : double(stats.probes) / operations) << "\n"
+      << "max probe: " << stats.max_probe << "\n"
+      << "full blocks: " << stats.full_blocks << "\n"
+      << "exhausted probes: " << stats.exhausted << "\n"
+      << "probe lengths:";
+  for (int i = 0; i < kProbeHistogramSize; ++i) out << " " << stats.probe_lengths[i];
+  return out << " (" << kProbeHistogramSize << " or more)\n";
+}
 
 template <class Key>
 class Table {
  public:
+  // View of a key that can be searched for without building a Key
+  typedef typename Key::View View;
   Table(unsigned table_size) { table_size_ = table_size; }
   virtual ~Table() {}
   virtual bool Search(const Key& key, int& index) const = 0;
+  virtual Key* Find(const View& key, int& index) const = 0;
   virtual bool Insert(const Key& key) = 0;
+  // Inserts a batch of keys at once, moving them into the table
+  virtual int InsertBulk(std::vector<Key>&& keys) = 0;
   virtual bool Delete(const Key& key) = 0;
+  virtual bool Delete(const View& key) = 0;
+  virtual void SearchBatch(const std::vector<View>& keys, std::vector<Key*>& results) const = 0;
+  virtual int DeleteBatch(const std::vector<View>& keys) = 0;
   virtual bool IsFull() const = 0;
-  virtual std::ostream& Write(std::ostream& out) const = 0;
-  virtual std::ostream& SaveToFile(std::ostream& out) const { return out; }
+  // Makes room for count keys at once, instead of growing while they are inserted
+  virtual void Reserve(int count) = 0;
+  virtual void ForEach(const std::function<void(const Key&)>& visit) const = 0;
+  // Visits the keys of a block, in the order they are stored in it
+  virtual void ForEachInBlock(unsigned block, const std::function<void(const Key&)>& visit) const = 0;
+  std::ostream& Write(std::ostream& out, const WriteOptions& options = WriteOptions()) const;
+  virtual std::ostream& SaveToFile(std::ostream& out) const;
   virtual void LoadFile(std::istream& in);
+  bool LoadFile(const std::string& path);
+  std::ostream& SaveSnapshot(std::ostream& out) const;
+  std::vector<Key> CopyKeys() const;
+  bool LoadSnapshot(const std::string& path);
+  // Chooses the fields FindAll() searches by, without rebuilding the table
   void SetSearchMode(int search_mode) { search_mode_ = search_mode; }
+  int GetSearchMode() const { return search_mode_; }
+  // Sets the fields the keys are hashed on, the ones of the search mode of the keys inserted
+  void SetKeyMode(int key_mode) { key_mode_ = key_mode; }
+  int GetKeyMode() const { return key_mode_; }
+  std::vector<Key*> FindAll(std::string_view name, std::string_view author, std::vector<int>* indexes = nullptr) const;
+  std::vector<Key*> FindByPrefix(std::string_view prefix, size_t limit) const;
+  std::vector<Key*> FindSimilar(std::string_view name, unsigned max_distance) const;
+  void BuildIndexes() const;
+  bool IsIndexed() const { return indexed_; }
+  const TableStats& Stats() const { return stats_; }
+  void ResetStats() { stats_ = TableStats(); }
+  // A max load factor of 0 disables the automatic growth of the table
+  void SetMaxLoadFactor(double max_load_factor) { max_load_factor_ = max_load_factor; }
+  int GetTableSize() const { return table_size_; }
+  int GetSize() const { return size_; }
  protected:
+  bool CanGrow() const { return max_load_factor_ > 0; }
+  bool MustGrow(double capacity) const { return CanGrow() && size_ + 1 > max_load_factor_ * capacity; }
+  unsigned GrownSize() const { return NextPrime(2 * table_size_ + 1); }
+  bool MustCleanUp(double capacity) const { return deleted_ > kMaxDeletedFactor * capacity; }
+  unsigned ReservedSize(int count, double block_size) const;
+  void LoadText(const char* data, size_t size);
+  void Index(const Key& key);
+  void Unindex(const Key& key);
+  View ExactView(std::string_view name, std::string_view author) const;
   int table_size_;
-  int search_mode_;
+  // Fields the keys are hashed on (0 -> Name; 1 -> Author; 2 -> Both)
+  int key_mode_ = 0;
+  // Fields the keys are searched by
+  int search_mode_ = 0;
+  int size_ = 0;
+  int deleted_ = 0;
+  double max_load_factor_ = kDefaultMaxLoadFactor;
+  // Updated by the searches too, which don't modify the table otherwise
+  mutable TableStats stats_;
+  // Strings of the keys stored in the table, destroyed after them
+  StringArena arena_;
+  // Indexes of the keys by each of their fields, built by the first query that needs them
+  mutable bool indexed_ = false;
+  mutable SecondaryIndex name_index_;
+  mutable SecondaryIndex author_index_;
+  // Index of the keys by the characters of their names
+  mutable TitleIndex title_index_;
 };
 
-template <class Key, class Container = StaticSequence<Key>>
-class HashTable : public Table<Key> {
+/** Operations every HashTable does the same way, written once over the ones of
+ *  the table that depend on its container. Derived is the HashTable, whose
+ *  operations are called directly, not through virtual calls, so the compiler
+ *  can inline them in the loops. The HashTable provides:
+ *  - Locate(key, index): searchs a key, counting its probes.
+ *  - Place(key): moves a key into the table, returning the number of blocks
+ *    probed, 0 if it has found no room.
+ *  - Erase(block, key): deletes a key found in a block.
+ *  - Rehash(table_size): rebuilds the table with a new number of blocks.
+ *  - IsBlockFull(block) and VisitBlock(block, visit).
+ *  - A Cursor and StartProbe(key, cursor) and ProbeStep(key, cursor, stored),
+ *    which walk the probe sequence of a key one memory access at a time, so
+ *    the batches interleave the ones of a group of keys (see LocateGroup()).
+ *  It may replace PlaceAtHome(), RebuildFor() and kTombstones too.
+ */
+template <class Derived, class Key>
+class HashTableBase : public Table<Key> {
  public:
-  HashTable(unsigned table_size, DisperseFunction<Key>& fd, ExplorationFunction<Key>& fe, unsigned block_size);
-  virtual ~HashTable();
+  HashTableBase(unsigned table_size, int block_size) : Table<Key>(table_size), block_size_(block_size) {}
+  typedef typename Table<Key>::View View;
   bool Search(const Key& key, int& index) const;
+  Key* Find(const View& key, int& index) const;
   bool Insert(const Key& key);
-  bool Delete(const Key& key);
+  int InsertBulk(std::vector<Key>&& keys);
+  bool Delete(const Key& key) { return Remove(key); }
+  bool Delete(const View& key) { return Remove(key); }
+  void SearchBatch(const std::vector<View>& keys, std::vector<Key*>& results) const;
+  int DeleteBatch(const std::vector<View>& keys);
   bool IsFull() const;
-  std::ostream& Write(std::ostream& out) const;
-  std::ostream& SaveToFile(std::ostream& out) const override;
- private:
-  DisperseFunction<Key>* fd_ = nullptr;
-  ExplorationFunction<Key>* fe_ = nullptr;
-  Container** table_;
+  void Reserve(int count);
+  void ForEach(const std::function<void(const Key&)>& visit) const;
+  void ForEachInBlock(unsigned block, const std::function<void(const Key&)>& visit) const;
+ protected:
+  // Whether the deletions leave tombstones, which the table is rebuilt to clean up
+  static constexpr bool kTombstones = false;
+  double Capacity() const { return double(this->table_size_) * block_size_; }
+  // Inserts a key of InsertBulk() in block order, 0 leaves it for Place() after the rest
+  int PlaceAtHome(Key&& key, unsigned /*home*/) { return derived().Place(std::move(key)); }
+  bool RebuildFor(const Key& key, int rebuilds);
+  // Number of keys a block holds, 1 for the tables whose blocks grow
   int block_size_;
+ private:
+  const Derived& derived() const { return static_cast<const Derived&>(*this); }
+  Derived& derived() { return static_cast<Derived&>(*this); }
+  template<class K> bool Remove(const K& key);
+  void LocateGroup(const View* keys, size_t count, Key** stored, unsigned* index) const;
+  void CleanUp(int deleted);
 };
 
-template <class Key>
-class HashTable<Key, DynamicSequence<Key>> : public Table<Key> {
+template <class Key, class Container = StaticSequence<Key>, class Fd = ModFunction<Key>, class Fe = LinearFunction<Key>>
+class HashTable : public HashTableBase<HashTable<Key, Container, Fd, Fe>, Key> {
  public:
-  HashTable(unsigned table_size, DisperseFunction<Key>& fd);
-  virtual ~HashTable();
-  bool Search(const Key& key, int& index) const;
-  bool Insert(const Key& key);
-  bool Delete(const Key& key);
-  bool IsFull() const;
-  std::ostream& Write(std::ostream& out) const;
+  HashTable(unsigned table_size, const Fd& fd, const Fe& fe, unsigned block_size);
+  typedef typename Table<Key>::View View;
  private:
-  DisperseFunction<Key>* fd_ = nullptr;
-  DynamicSequence<Key>** table_;
+  friend class HashTableBase<HashTable, Key>;
+  typedef typename BlockStorage<Key, Container>::Type Storage;
+  // Position of the probe sequence of a key of a batch
+  struct Cursor {
+    unsigned block;
+    unsigned home;
+    int attempt;
+    // Number of levels of the block prefetched
+    int step;
+  };
+  static constexpr bool kTombstones = true;
+  template<class K> Key* Locate(const K& key, unsigned& index) const;
+  template<class K> int Place(K&& key);
+  template<class K> int Explore(K&& key, unsigned home);
+  int PlaceAtHome(Key&& key, unsigned home) { return table_.Insert(home, std::move(key)) ? 1 : 0; }
+  template<class K> bool Erase(unsigned block, const K& key) { return table_.Delete(block, key); }
+  void Rehash(unsigned table_size);
+  bool IsBlockFull(unsigned block) const { return table_.IsFull(block); }
+  template<class Visitor> void VisitBlock(unsigned block, Visitor&& visit) const { table_.ForEachInBlock(block, visit); }
+  void StartProbe(const View& key, Cursor& cursor) const;
+  bool ProbeStep(const View& key, Cursor& cursor, Key*& stored) const;
+  Fd fd_;
+  Fe fe_;
+  Storage table_;
+};
+
+template <class Key, class Fd, class Fe>
+class HashTable<Key, DynamicSequence<Key>, Fd, Fe> : public HashTableBase<HashTable<Key, DynamicSequence<Key>, Fd, Fe>, Key> {
+ public:
+  HashTable(unsigned table_size, const Fd& fd);
+  typedef typename Table<Key>::View View;
+ private:
+  friend class HashTableBase<HashTable, Key>;
+  struct Cursor {
+    unsigned block;
+    int step;
+  };
+  template<class K> Key* Locate(const K& key, unsigned& index) const;
+  int Place(Key&& key) { return table_.Insert(fd_(key), std::move(key)) ? 1 : 0; }
+  template<class K> bool Erase(unsigned block, const K& key) { return table_.Delete(block, key); }
+  void Rehash(unsigned table_size);
+  // A sequence holds any number of keys
+  bool IsBlockFull(unsigned /*block*/) const { return false; }
+  template<class Visitor> void VisitBlock(unsigned block, Visitor&& visit) const { table_.ForEachInBlock(block, visit); }
+  void StartProbe(const View& key, Cursor& cursor) const;
+  bool ProbeStep(const View& key, Cursor& cursor, Key*& stored) const;
+  Fd fd_;
+  SequenceBlocks<Key, DynamicSequence<Key>> table_;
+};
+
+template <class Key, class Fd>
+class HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>> : public HashTableBase<HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>, Key> {
+ public:
+  HashTable(unsigned table_size, const Fd& fd, const RobinHoodFunction<Key>& /*fe*/, unsigned block_size);
+  typedef typename Table<Key>::View View;
+ private:
+  friend class HashTableBase<HashTable, Key>;
+  struct Cursor {
+    unsigned block;
+    unsigned home;
+    unsigned distance;
+  };
+  unsigned* Distances(unsigned block) { return distances_.data() + size_t(block) * this->block_size_; }
+  const unsigned* Distances(unsigned block) const { return distances_.data() + size_t(block) * this->block_size_; }
+  template<class K> Key* Probe(const K& key, unsigned block, unsigned distance, bool& passable) const;
+  template<class K> Key* Seek(const K& key, unsigned& index, unsigned& probes) const;
+  template<class K> Key* Locate(const K& key, unsigned& index) const;
+  template<class K> bool Erase(unsigned block, const K& key);
+  void EraseSlot(unsigned block, int slot);
+  int Place(Key&& key);
+  void Rehash(unsigned table_size);
+  bool IsBlockFull(unsigned block) const { return table_.IsFull(block); }
+  template<class Visitor> void VisitBlock(unsigned block, Visitor&& visit) const { table_.ForEachInBlock(block, visit); }
+  void StartProbe(const View& key, Cursor& cursor) const;
+  bool ProbeStep(const View& key, Cursor& cursor, Key*& stored) const;
+  Fd fd_;
+  FlatSequence<Key> table_;
+  // Number of blocks from its home block to the one of the key of every slot, kNoDistance if it has no key
+  std::vector<unsigned> distances_;
+  // Number of slots with a key, which may be less than the size of the table while it is rebuilt
+  int occupied_ = 0;
+};
+
+template <class Key, class Fd, class Fe>
+class HashTable<Key, CuckooSequence<Key>, Fd, Fe> : public HashTableBase<HashTable<Key, CuckooSequence<Key>, Fd, Fe>, Key> {
+ public:
+  HashTable(unsigned table_size, const Fd& fd, unsigned block_size);
+  typedef typename Table<Key>::View View;
+  bool IsFull() const { return stash_.size() >= kCuckooStashSize && HashTableBase<HashTable, Key>::IsFull(); }
+ private:
+  friend class HashTableBase<HashTable, Key>;
+  // A block of the search of a displacement path, reached by moving the key
+  // of a slot of the previous block of the path to its other candidate block
+  struct CuckooStep {
+    unsigned block;
+    int previous;
+    int slot;
+  };
+  struct Cursor {
+    unsigned block;
+    unsigned first;
+    unsigned second;
+  };
+  // The second candidate block of a key: a random number of its sequence, independent of the disperse functions
+  template<class K> unsigned Alternate(const K& key) const { return RandomAt(HashValue(key), seed_) % this->table_size_; }
+  template<class K> Key* Locate(const K& key, unsigned& index) const;
+  template<class K> Key* LocateIn(const K& key, unsigned first, unsigned second, unsigned& index) const;
+  template<class K> bool Erase(unsigned block, const K& key);
+  template<class K> int Place(K&& key);
+  int FindPath(unsigned first, unsigned second, std::vector<CuckooStep>& path) const;
+  template<class K> int Displace(const std::vector<CuckooStep>& path, int free, K&& key);
+  template<class K> bool Crowded(const K& key) const;
+  bool RebuildFor(const Key& key, int rebuilds);
+  void MakeRoom();
+  void Rehash(unsigned table_size);
+  bool IsBlockFull(unsigned block) const { return table_.IsFull(block); }
+  template<class Visitor> void VisitBlock(unsigned block, Visitor&& visit) const;
+  void StartProbe(const View& key, Cursor& cursor) const;
+  bool ProbeStep(const View& key, Cursor& cursor, Key*& stored) const;
+  Fd fd_;
+  CuckooSequence<Key> table_;
+  // Keys that found no room in their candidate blocks, kCuckooStashSize at most
+  std::vector<Key> stash_;
+  // Position of the random sequence of the keys their alternate blocks are taken from
+  HashValue seed_ = 1;
+  // Number of times the table has been rebuilt with a new seed since it last grew
+  int reseeds_ = 0;
 };
 
 inline std::string trim(const std::string& str) {
@@ -64,250 +363,1312 @@ inline std::string trim(const std::string& str) {
   return str.substr(first, (last - first + 1));
 }
 
-// ================================ HASH TABLE STATIC SEQUENCE ================================ //
+/** @brief Sorts the positions of a batch of keys by their home block with a
+ *         counting sort, keeping the order of the batch inside every block.
+ *  @param[in] keys. The keys of the batch.
+ *  @param[in] fd. The disperse function of the table.
+ *  @param[in] table_size. The number of blocks of the table.
+ *  @param[out] home. The home block of every key.
+ *  @return The positions of the keys, grouped by home block.
+ */
+template<class Key, class Fd>
+std::vector<unsigned> OrderByHome(const std::vector<Key>& keys, const Fd& fd, unsigned table_size, std::vector<unsigned>& home) {
+  home.resize(keys.size());
+  std::vector<unsigned> first(table_size + 1, 0);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    home[i] = fd(keys[i]);
+    ++first[home[i] + 1];
+  }
+  for (unsigned block = 0; block < table_size; ++block) first[block + 1] += first[block];
+  std::vector<unsigned> order(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) order[first[home[i]]++] = i;
+  return order;
+}
 
-template<class Key, class Container>
-HashTable<Key, Container>::HashTable(unsigned table_size, DisperseFunction<Key>& fd, ExplorationFunction<Key>& fe, unsigned block_size) : Table<Key>(table_size) {
-  this->table_size_ = table_size;
-  fd_ = &fd;
-  fe_ = &fe;
-  table_ = new Container*[table_size];
-  block_size_ = block_size;
-  for (unsigned i = 0; i < table_size; ++i) {
-    table_[i] = new Container(block_size);
+/** @brief Writes a book as a line of the database file
+ *  @param[in] out. The output stream.
+ *  @param[in] book. The book to write.
+ */
+template<class Key>
+void SaveRecord(std::ostream& out, const Key& book) {
+  const ReservationList& reservations = book.GetReservations();
+  out << book.GetName() << " | "
+      << book.GetAuthor() << " | "
+      << (reservations.empty() ? "Disponible" : "Reservado") << " | "
+      << std::fixed << std::setprecision(2) << book.GetPrice() << "€ | ";
+  if (reservations.empty()) {
+    out << "-\n";
+  } 
+  else {
+    for (size_t i = 0; i < reservations.size(); ++i) {
+      if (i > 0) out << ", ";
+      out << reservations[i].name << " @ " << reservations[i].return_date;
+    }
+    out << "\n";
   }
 }
 
-template<class Key, class Container>
-HashTable<Key, Container>::~HashTable() {
-  delete fd_;
-  delete fe_;
-  for (int i = 0; i < this->table_size_; ++i) {
-    delete table_[i];
-  }
-  delete[] table_;
-}
-
-template<class Key, class Container>
-bool HashTable<Key, Container>::Search(const Key& key, int& index) const {
-  index = (*fd_)(key);
-  if (!table_[index]->Search(key)) {
-    if (table_[(*fd_)(key)]->IsFull()) {
-      int attempt = 1;
-      unsigned aux_index = ((*fd_)(key) + (*fe_)(key, attempt)) % this->table_size_;
-      while (!table_[aux_index]->Search(key) && table_[aux_index]->IsFull()) {
-        ++attempt;
-        if (attempt > this->table_size_) {
-          std::cout << "All possible indexes have been tried" << std::endl;
-          return false;
-        }
-        aux_index = ((*fd_)(key) + (*fe_)(key, attempt)) % this->table_size_;
-      }
-      index = aux_index;
-      return true;
+/** @brief Appends a book to a text as it is shown in the table, with the
+ *         price written as std::to_string() does
+ *  @param[in,out] text. The text the book is appended to.
+ *  @param[in] book. The book to append.
+ */
+template<class Key>
+void AppendEntry(std::string& text, const Key& book) {
+  char price[64];
+  char* price_end = std::to_chars(price, price + sizeof(price), book.GetPrice(), std::chars_format::fixed, 6).ptr;
+  text.append(book.GetName()).append(", ").append(book.GetAuthor()).append(" -> ");
+  text.append(price, price_end).append("€");
+}
+
+/** @brief Gets the number of blocks a table needs to hold some keys without
+ *         going over its max load factor.
+ *  @param[in] count. The number of keys.
+ *  @param[in] block_size. The number of keys a block holds at full load.
+ *  @return The number of blocks, or 0 if the table doesn't grow.
+ */
+template<class Key>
+unsigned Table<Key>::ReservedSize(int count, double block_size) const {
+  if (!CanGrow()) return 0;
+  return NextPrime(unsigned(std::ceil(count / (max_load_factor_ * block_size))));
+}
+
+/** @brief Gets a view of a key hashed on the fields of the key mode of the
+ *         table but compared on both fields, so that only the key with that
+ *         name and author is found among the ones hashed alike.
+ *  @param[in] name. The name of the key.
+ *  @param[in] author. The author of the key.
+ *  @return The view.
+ */
+template<class Key>
+typename Table<Key>::View Table<Key>::ExactView(std::string_view name, std::string_view author) const {
+  return View(HashValue(View(name, author, key_mode_)), name, author, 2);
+}
+
+/** @brief Finds the keys whose fields of the search mode are equal to the
+ *         ones given. A search by both fields looks up the key in the table,
+ *         the others visit the secondary index of the field and look up every
+ *         key of it in the table by its name and author.
+ *  @param[in] name. The name searched, ignored if the search mode is 1.
+ *  @param[in] author. The author searched, ignored if the search mode is 0.
+ *  @param[out] indexes. The block of every key found, if it is not nullptr.
+ *  @return A pointer to every key found.
+ */
+template<class Key>
+std::vector<Key*> Table<Key>::FindAll(std::string_view name, std::string_view author, std::vector<int>* indexes) const {
+  std::vector<std::pair<Key*, int>> found;
+  auto find = [&](std::string_view name, std::string_view author) {
+    int index;
+    Key* key = Find(ExactView(name, author), index);
+    if (key != nullptr) found.emplace_back(key, index);
+  };
+  if (search_mode_ == 2) {
+    find(name, author);
+  }
+  else {
+    BuildIndexes();
+    const SecondaryIndex& field_index = search_mode_ == 0 ? name_index_ : author_index_;
+    field_index.ForEach(search_mode_ == 0 ? name : author, [&find](const IndexedBook& book) { find(book.name, book.author); });
+    // The keys inserted more than once are found once
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+  }
+  std::vector<Key*> keys;
+  if (indexes != nullptr) indexes->clear();
+  for (const auto& entry : found) {
+    keys.push_back(entry.first);
+    if (indexes != nullptr) indexes->push_back(entry.second);
+  }
+  return keys;
+}
+
+/** @brief Finds the keys whose name starts with a text, without the case of
+ *         the letters, in the title index.
+ *  @param[in] prefix. The text.
+ *  @param[in] limit. The maximum number of keys found.
+ *  @return A pointer to every key found, in the order of their names.
+ */
+template<class Key>
+std::vector<Key*> Table<Key>::FindByPrefix(std::string_view prefix, size_t limit) const {
+  std::vector<Key*> found;
+  // The keys inserted more than once are found once
+  std::unordered_set<const Key*> seen;
+  int index;
+  if (limit == 0) return found;
+  BuildIndexes();
+  // The limit counts the keys found, after the repeated ones are skipped
+  title_index_.ForEachWithPrefix(prefix, [&](const IndexedBook& book) {
+    Key* key = Find(ExactView(book.name, book.author), index);
+    if (key != nullptr && seen.insert(key).second) found.push_back(key);
+    return found.size() < limit;
+  });
+  return found;
+}
+
+/** @brief Finds the keys whose name is at most some typos away from a text, in
+ *         the title index.
+ *  @param[in] name. The text.
+ *  @param[in] max_distance. The maximum number of characters inserted, deleted
+ *             or replaced, at most kMaxTitleDistance.
+ *  @return A pointer to every key found, the closest ones first.
+ */
+template<class Key>
+std::vector<Key*> Table<Key>::FindSimilar(std::string_view name, unsigned max_distance) const {
+  std::vector<std::pair<unsigned, Key*>> found;
+  std::unordered_set<const Key*> seen;
+  int index;
+  BuildIndexes();
+  title_index_.ForEachSimilar(name, max_distance, [&](const IndexedBook& book, unsigned distance) {
+    Key* key = Find(ExactView(book.name, book.author), index);
+    if (key != nullptr && seen.insert(key).second) found.emplace_back(distance, key);
+  });
+  // The keys come in the order of their names, which is kept between the ones at the same distance
+  std::stable_sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  std::vector<Key*> keys;
+  for (const auto& entry : found) keys.push_back(entry.second);
+  return keys;
+}
+
+/** @brief Builds the secondary indexes from the keys of the table in one pass,
+ *         if they have not been built yet. Until a query needs them, the
+ *         insertions and deletions don't maintain them.
+ */
+template<class Key>
+void Table<Key>::BuildIndexes() const {
+  if (indexed_) return;
+  indexed_ = true;
+  name_index_.Reserve(size_);
+  author_index_.Reserve(size_);
+  ForEach([this](const Key& key) {
+    IndexedBook book = {key.GetName(), key.GetAuthor()};
+    name_index_.Add(book.name, book);
+    author_index_.Add(book.author, book);
+    title_index_.Add(book);
+  });
+}
+
+/** @brief Adds a key to the secondary indexes, if they have been built
+ *  @param[in] key. The key, whose strings are stored in the arena of the table.
+ */
+template<class Key>
+void Table<Key>::Index(const Key& key) {
+  if (!indexed_) return;
+  IndexedBook book = {key.GetName(), key.GetAuthor()};
+  name_index_.Add(book.name, book);
+  author_index_.Add(book.author, book);
+  title_index_.Add(book);
+}
+
+/** @brief Removes a key from the secondary indexes, if they have been built
+ *  @param[in] key. The key, stored in the table.
+ */
+template<class Key>
+void Table<Key>::Unindex(const Key& key) {
+  if (!indexed_) return;
+  IndexedBook book = {key.GetName(), key.GetAuthor()};
+  name_index_.Remove(book.name, book);
+  author_index_.Remove(book.author, book);
+  title_index_.Remove(book);
+}
+
+/** @brief Writes some books in the text format of the database file
+ *  @param[in] out. The output stream.
+ *  @param[in] for_each. The function that visits every book written.
+ *  @return The output stream.
+ */
+template<class Key, class ForEachKey>
+std::ostream& WriteDatabase(std::ostream& out, ForEachKey&& for_each) {
+  out << "Nombre del libro | Autor | Estado | Precio | Reservas\n";
+  out << "------------------------------------------------------\n";
+  for_each([&out](const Key& book) { SaveRecord(out, book); });
+  return out;
+}
+
+/** @brief Writes the table in the text format of the database file
+ *  @param[in] out. The output stream.
+ *  @return The output stream.
+ */
+template<class Key>
+std::ostream& Table<Key>::SaveToFile(std::ostream& out) const {
+  return WriteDatabase<Key>(out, [this](const std::function<void(const Key&)>& visit) { ForEach(visit); });
+}
+
+/** @brief Copies the keys of the table. The copies view the strings of the
+ *         arena of the table, which never change, so copying a key doesn't copy
+ *         them and the copies can be written while the table changes.
+ *  @return The copies, valid as long as the table.
+ */
+template<class Key>
+std::vector<Key> Table<Key>::CopyKeys() const {
+  std::vector<Key> keys;
+  keys.reserve(size_);
+  ForEach([&keys](const Key& key) { keys.push_back(key); });
+  return keys;
+}
+
+/** @brief Writes the keys of a range of blocks, one block per line. The text
+ *         is gathered in a buffer that is written to the stream when full.
+ *  @param[in] out. The output stream.
+ *  @param[in] options. The blocks to write.
+ *  @return The output stream.
+ */
+template<class Key>
+std::ostream& Table<Key>::Write(std::ostream& out, const WriteOptions& options) const {
+  std::string buffer;
+  buffer.reserve(kWriteBufferSize);
+  char number[16];
+  unsigned last_block = std::min(options.last_block, unsigned(table_size_));
+  for (unsigned block = options.first_block; block < last_block; ++block) {
+    size_t line_start = buffer.size();
+    buffer.append("Table[").append(number, std::to_chars(number, number + sizeof(number), block).ptr).append("]: ");
+    size_t keys_start = buffer.size();
+    ForEachInBlock(block, [&buffer](const Key& key) {
+      AppendEntry(buffer, key);
+      buffer.append(" | ");
+    });
+    if (options.non_empty_only && buffer.size() == keys_start) {
+      buffer.resize(line_start);
+      continue;
+    }
+    buffer.push_back('\n');
+    if (buffer.size() >= kWriteBufferSize) {
+      out.write(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  }
+  return out.write(buffer.data(), buffer.size());
+}
+
+/** @brief Writes some books as a binary snapshot (see snapshot.h)
+ *  @param[in] out. The output stream, opened in binary mode.
+ *  @param[in] count. The number of books.
+ *  @param[in] key_mode. The fields the books are hashed on.
+ *  @param[in] for_each. The function that visits every book written.
+ *  @return The output stream.
+ */
+template<class Key, class ForEachKey>
+std::ostream& WriteSnapshot(std::ostream& out, size_t count, int key_mode, ForEachKey&& for_each) {
+  std::vector<SnapshotBook> books;
+  std::vector<SnapshotReservation> reservations;
+  std::string strings;
+  books.reserve(count);
+  for_each([&](const Key& book) {
+    SnapshotBook record;
+    record.hash = HashValue(book);
+    record.price = book.GetPrice();
+    record.name = AddSnapshotString(strings, book.GetName());
+    record.author = AddSnapshotString(strings, book.GetAuthor());
+    record.first_reservation = reservations.size();
+    for (const Reservation& reservation : book.GetReservations()) {
+      reservations.push_back({AddSnapshotString(strings, reservation.name.str()), reservation.start_date.Days(), reservation.return_date.Days()});
     }
-    else {
+    record.reservation_count = reservations.size() - record.first_reservation;
+    books.push_back(record);
+  });
+  SnapshotHeader header;
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+  header.version = kSnapshotVersion;
+  header.search_mode = key_mode;
+  header.hash_seed = Key::GetHashSeed();
+  header.book_count = books.size();
+  header.reservation_count = reservations.size();
+  header.string_bytes = strings.size();
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(books.data()), books.size() * sizeof(SnapshotBook));
+  out.write(reinterpret_cast<const char*>(reservations.data()), reservations.size() * sizeof(SnapshotReservation));
+  out.write(strings.data(), strings.size());
+  return out;
+}
+
+/** @brief Writes the table as a binary snapshot (see snapshot.h)
+ *  @param[in] out. The output stream, opened in binary mode.
+ *  @return The output stream.
+ */
+template<class Key>
+std::ostream& Table<Key>::SaveSnapshot(std::ostream& out) const {
+  return WriteSnapshot<Key>(out, size_, key_mode_, [this](const std::function<void(const Key&)>& visit) { ForEach(visit); });
+}
+
+/** @brief Loads a binary snapshot into the table. The file is mapped in memory
+ *         and its records are read in place, then they are inserted in a
+ *         single bulk insertion.
+ *  @param[in] path. The path of the snapshot.
+ *  @return True if the snapshot has been loaded, false if it can't be read or
+ *          it is not a valid snapshot, in which case the table is not modified.
+ */
+template<class Key>
+bool Table<Key>::LoadSnapshot(const std::string& path) {
+  MappedFile file(path);
+  if (!file.IsOpen() || file.GetSize() < sizeof(SnapshotHeader)) return false;
+  SnapshotHeader header;
+  std::memcpy(&header, file.GetData(), sizeof(header));
+  if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 || header.version != kSnapshotVersion) return false;
+  uint64_t available = file.GetSize() - sizeof(SnapshotHeader);
+  if (header.book_count > available / sizeof(SnapshotBook)) return false;
+  available -= header.book_count * sizeof(SnapshotBook);
+  if (header.reservation_count > available / sizeof(SnapshotReservation)) return false;
+  available -= header.reservation_count * sizeof(SnapshotReservation);
+  if (header.string_bytes != available) return false;
+  const SnapshotBook* books = reinterpret_cast<const SnapshotBook*>(file.GetData() + sizeof(SnapshotHeader));
+  const SnapshotReservation* reservations = reinterpret_cast<const SnapshotReservation*>(books + header.book_count);
+  const char* strings = reinterpret_cast<const char*>(reservations + header.reservation_count);
+  // Every record is checked before the table is modified
+  for (uint64_t i = 0; i < header.book_count; ++i) {
+    const SnapshotBook& book = books[i];
+    if (!IsValidSnapshotString(book.name, header.string_bytes) || !IsValidSnapshotString(book.author, header.string_bytes)) return false;
+    if (book.first_reservation > header.reservation_count || book.reservation_count > header.reservation_count - book.first_reservation) return false;
+  }
+  for (uint64_t i = 0; i < header.reservation_count; ++i) {
+    const SnapshotReservation& reservation = reservations[i];
+    if (!IsValidSnapshotString(reservation.name, header.string_bytes)) return false;
+  }
+  auto view = [strings](const SnapshotString& slice) { return std::string_view(strings + slice.offset, slice.length); };
+  // The stored hashes are only valid for the search mode and seed they were computed with
+  bool same_hash = int(header.search_mode) == key_mode_ && header.hash_seed == Key::GetHashSeed();
+  std::vector<Key> loaded;
+  loaded.reserve(header.book_count);
+  for (uint64_t i = 0; i < header.book_count; ++i) {
+    const SnapshotBook& record = books[i];
+    Key& book = same_hash ? loaded.emplace_back(view(record.name), view(record.author), record.price, key_mode_, record.hash)
+                          : loaded.emplace_back(view(record.name), view(record.author), record.price, key_mode_);
+    for (uint64_t j = 0; j < record.reservation_count; ++j) {
+      const SnapshotReservation& reservation = reservations[record.first_reservation + j];
+      book.AddReservation({ReaderName(view(reservation.name)), Date(reservation.start_day), Date(reservation.return_day)});
+    }
+  }
+  InsertBulk(std::move(loaded));
+  return true;
+}
+
+/** @brief Loads the books of the text database (see text_loader.h). The text
+ *         is parsed on every core and the books are inserted afterwards in a
+ *         single bulk insertion.
+ *  @param[in] data. The contents of the database file.
+ *  @param[in] size. The size of the database file.
+ */
+template<class Key>
+void Table<Key>::LoadText(const char* data, size_t size) {
+  std::vector<std::vector<Key>> chunks = ParseDatabase<Key>(data, size, key_mode_);
+  for (size_t i = 1; i < chunks.size(); ++i) {
+    std::move(chunks[i].begin(), chunks[i].end(), std::back_inserter(chunks[0]));
+    std::vector<Key>().swap(chunks[i]);
+  }
+  // The books that find no room are counted in stats_.exhausted by InsertBulk()
+  InsertBulk(std::move(chunks[0]));
+}
+
+template<class Key>
+void Table<Key>::LoadFile(std::istream& in) {
+  std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  LoadText(text.data(), text.size());
+}
+
+/** @brief Loads a text database file, which is mapped in memory instead of read
+ *  @param[in] path. The path of the file.
+ *  @return True if the file has been loaded, false if it can't be opened.
+ */
+template<class Key>
+bool Table<Key>::LoadFile(const std::string& path) {
+  MappedFile file(path);
+  if (file.IsOpen()) {
+    LoadText(file.GetData(), file.GetSize());
+    return true;
+  }
+  // Empty files can't be mapped
+  std::ifstream in(path);
+  if (!in) return false;
+  LoadFile(in);
+  return true;
+}
+
+// ================================ HASH TABLE BASE ================================ //
+
+template<class Derived, class Key>
+bool HashTableBase<Derived, Key>::Search(const Key& key, int& index) const {
+  unsigned block;
+  bool found = derived().Locate(key, block) != nullptr;
+  index = block;
+  return found;
+}
+
+/** @brief Searchs a key in the table from a view of it
+ *  @param[in] key. The view of the key to search.
+ *  @param[out] index. The block where the key is, or its home block if it is not found.
+ *  @return A pointer to the stored key, nullptr if it is not in the table.
+ */
+template<class Derived, class Key>
+Key* HashTableBase<Derived, Key>::Find(const View& key, int& index) const {
+  unsigned block;
+  Key* stored = derived().Locate(key, block);
+  index = block;
+  return stored;
+}
+
+/** @brief Rebuilds the table after a key has found no room in it, growing it
+ *  @param[in] key. The key that has found no room.
+ *  @param[in] rebuilds. The number of times the table has been rebuilt for the key.
+ *  @return True if the table has been rebuilt, false if the key must be rejected.
+ */
+template<class Derived, class Key>
+bool HashTableBase<Derived, Key>::RebuildFor(const Key& /*key*/, int /*rebuilds*/) {
+  if (!this->CanGrow()) return false;
+  derived().Rehash(this->GrownSize());
+  return true;
+}
+
+/** @brief Inserts a key in the table. The table grows when the key would take
+ *         it over its max load factor, and it is rebuilt when it finds no room
+ *         for the key (see RebuildFor()).
+ *  @param[in] key. The key to insert.
+ *  @return True if the key has been inserted, false otherwise.
+ */
+template<class Derived, class Key>
+bool HashTableBase<Derived, Key>::Insert(const Key& key) {
+  if (this->MustGrow(Capacity())) derived().Rehash(this->GrownSize());
+  Key stored(key, this->arena_);
+  this->Index(stored);
+  int probes;
+  for (int rebuilds = 0; (probes = derived().Place(std::move(stored))) == 0; ++rebuilds) {
+    ++this->stats_.exhausted;
+    if (!derived().RebuildFor(stored, rebuilds)) {
+      this->Unindex(stored);
       return false;
     }
   }
+  this->stats_.RecordInsert(probes);
+  ++this->size_;
   return true;
 }
 
-template<class Key, class Container>
-bool HashTable<Key, Container>::Insert(const Key& key) {
-  if (!table_[(*fd_)(key)]->Insert(key)) {
-    std::cout << std::setw(4) << "Collision Detected!" << std::endl << std::endl;
-    int attempt = 1;
-    unsigned aux_index = ((*fd_)(key) + (*fe_)(key, attempt)) % this->table_size_;
-    while (!table_[aux_index]->Insert(key)) {
-      std::cout << std::setw(4) << "Collision Detected!" << std::endl << std::endl;
-      ++attempt;
-      if (attempt > this->table_size_) {
-        std::cout << "All possible indexes have been tried" << std::endl << std::endl;
-        return false;
-      }
-      aux_index = ((*fd_)(key) + (*fe_)(key, attempt)) % this->table_size_;
+/** @brief Inserts a batch of keys. The table is sized for all of them first,
+ *         then the keys are placed in the order of their home blocks, so every
+ *         block is filled in one go, and only the keys that find no room there
+ *         (see PlaceAtHome()) are placed after the rest.
+ *  @param[in] keys. The keys to insert, moved into the table.
+ *  @return The number of keys inserted.
+ */
+template<class Derived, class Key>
+int HashTableBase<Derived, Key>::InsertBulk(std::vector<Key>&& keys) {
+  Reserve(this->size_ + keys.size());
+  for (Key& key : keys) {
+    key.StoreIn(this->arena_);
+    this->Index(key);
+  }
+  std::vector<unsigned> home;
+  std::vector<unsigned> overflow;
+  int inserted = 0;
+  for (unsigned i : OrderByHome(keys, derived().fd_, this->table_size_, home)) {
+    int probes = derived().PlaceAtHome(std::move(keys[i]), home[i]);
+    if (probes == 0) {
+      overflow.push_back(i);
+      continue;
     }
-    return true;
+    this->stats_.RecordInsert(probes);
+    // The keys placed count for the load of the rebuilds of the next ones
+    ++this->size_;
+    ++inserted;
   }
+  for (unsigned i : overflow) {
+    // The home block is tried again, the table may have grown since
+    int probes;
+    for (int rebuilds = 0; (probes = derived().Place(std::move(keys[i]))) == 0; ++rebuilds) {
+      ++this->stats_.exhausted;
+      if (!derived().RebuildFor(keys[i], rebuilds)) break;
+    }
+    if (probes == 0) {
+      this->Unindex(keys[i]);
+      continue;
+    }
+    this->stats_.RecordInsert(probes);
+    ++this->size_;
+    ++inserted;
+  }
+  return inserted;
+}
+
+/** @brief Counts some deletions in the tombstones of the table, which is
+ *         rebuilt once they have left its probe chains longer than they need to be.
+ *  @param[in] deleted. The number of keys deleted.
+ */
+template<class Derived, class Key>
+void HashTableBase<Derived, Key>::CleanUp(int deleted) {
+  if (!Derived::kTombstones) return;
+  this->deleted_ += deleted;
+  if (this->MustCleanUp(Capacity())) derived().Rehash(this->table_size_);
+}
+
+/** @brief Deletes a key from the table
+ *  @param[in] key. The key to delete, or a view of it.
+ *  @return True if the key has been deleted, false otherwise.
+ */
+template<class Derived, class Key>
+template<class K>
+bool HashTableBase<Derived, Key>::Remove(const K& key) {
+  unsigned block;
+  Key* stored = derived().Locate(key, block);
+  if (stored == nullptr) return false;
+  this->Unindex(*stored);
+  derived().Erase(block, key);
+  --this->size_;
+  CleanUp(1);
   return true;
 }
 
-template<class Key, class Container>
-bool HashTable<Key, Container>::Delete(const Key& key) {
-  int index = (*fd_)(key);
-  if (table_[index]->Search(key)) {
-    return table_[index]->Delete(key);
+/** @brief Locates a group of keys overlapping their memory accesses. Every
+ *         step of a probe sequence reads what the previous one has prefetched,
+ *         so the group is walked round-robin, one step of every key at a time:
+ *         the keys are hashed and the first level of their blocks prefetched,
+ *         then every level is read while the next one of the other keys loads.
+ *  @param[in] keys. The views of the keys to locate.
+ *  @param[in] count. The number of keys, at most kBatchGroupSize.
+ *  @param[out] stored. A pointer to every stored key, nullptr if it is not in the table.
+ *  @param[out] index. The block where every key has been found.
+ */
+template<class Derived, class Key>
+void HashTableBase<Derived, Key>::LocateGroup(const View* keys, size_t count, Key** stored, unsigned* index) const {
+  typename Derived::Cursor cursor[kBatchGroupSize];
+  bool done[kBatchGroupSize];
+  for (size_t i = 0; i < count; ++i) {
+    derived().StartProbe(keys[i], cursor[i]);
+    stored[i] = nullptr;
+    done[i] = false;
   }
-  else {
-    if (table_[(*fd_)(key)]->IsFull()) {
-      int attempt = 1;
-      unsigned aux_index = ((*fd_)(key) + (*fe_)(key, attempt)) % this->table_size_;
-      while (!table_[aux_index]->Search(key) && table_[aux_index]->IsFull()) {
-        ++attempt;
-        if (attempt > this->table_size_) {
-          std::cout << "All possible indexes have been tried" << std::endl;
-          return false;
-        }
-        aux_index = ((*fd_)(key) + (*fe_)(key, attempt)) % this->table_size_;
-      }
-      if (table_[aux_index]->Search(key)) {
-        table_[aux_index]->Delete(key);
-        return true;
-      }
+  size_t pending = count;
+  while (pending > 0) {
+    for (size_t i = 0; i < count; ++i) {
+      if (done[i] || !derived().ProbeStep(keys[i], cursor[i], stored[i])) continue;
+      index[i] = cursor[i].block;
+      done[i] = true;
+      --pending;
     }
   }
-  return false;
 }
 
-template<class Key, class Container>
-bool HashTable<Key, Container>::IsFull() const {
+/** @brief Searchs a batch of keys in the table, overlapping the cache misses
+ *         of groups of kBatchGroupSize keys.
+ *  @param[in] keys. The views of the keys to search.
+ *  @param[out] results. A pointer to every stored key, nullptr if it is not in the table.
+ */
+template<class Derived, class Key>
+void HashTableBase<Derived, Key>::SearchBatch(const std::vector<View>& keys, std::vector<Key*>& results) const {
+  unsigned index[kBatchGroupSize];
+  results.resize(keys.size());
+  for (size_t first = 0; first < keys.size(); first += kBatchGroupSize) {
+    LocateGroup(keys.data() + first, std::min(kBatchGroupSize, keys.size() - first), results.data() + first, index);
+  }
+}
+
+/** @brief Deletes a batch of keys from the table. Every group is located at
+ *         once before its keys are deleted, and the table is only cleaned up
+ *         after the whole batch.
+ *  @param[in] keys. The views of the keys to delete.
+ *  @return The number of keys deleted.
+ */
+template<class Derived, class Key>
+int HashTableBase<Derived, Key>::DeleteBatch(const std::vector<View>& keys) {
+  Key* stored[kBatchGroupSize];
+  unsigned index[kBatchGroupSize];
+  int deleted = 0;
+  for (size_t first = 0; first < keys.size(); first += kBatchGroupSize) {
+    size_t count = std::min(kBatchGroupSize, keys.size() - first);
+    LocateGroup(keys.data() + first, count, stored, index);
+    // Erasing a key may move the others, so the group is unindexed first
+    for (size_t i = 0; i < count; ++i) {
+      if (stored[i] != nullptr) this->Unindex(*stored[i]);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      if (stored[i] != nullptr && derived().Erase(index[i], keys[first + i])) ++deleted;
+    }
+  }
+  this->size_ -= deleted;
+  CleanUp(deleted);
+  return deleted;
+}
+
+template<class Derived, class Key>
+bool HashTableBase<Derived, Key>::IsFull() const {
+  // A table that grows is never full
+  if (this->CanGrow()) return false;
   for (int i = 0; i < this->table_size_; ++i) {
-    if (!table_[i]->IsFull()) return false;
+    if (!derived().IsBlockFull(i)) return false;
   }
   return true;
 }
 
-template<class Key, class Container>
-std::ostream& HashTable<Key, Container>::Write(std::ostream& out) const {
+template<class Derived, class Key>
+void HashTableBase<Derived, Key>::Reserve(int count) {
+  unsigned table_size = this->ReservedSize(count, block_size_);
+  if (table_size > unsigned(this->table_size_)) derived().Rehash(table_size);
+}
+
+template<class Derived, class Key>
+void HashTableBase<Derived, Key>::ForEach(const std::function<void(const Key&)>& visit) const {
   for (int i = 0; i < this->table_size_; ++i) {
-    std::cout << "Table[" << i << "]: ";
-    table_[i]->Write(std::cout);
-    std::cout << std::endl;
+    derived().VisitBlock(i, visit);
   }
-  return out;
 }
 
-template<class Key, class Container>
-std::ostream& HashTable<Key, Container>::SaveToFile(std::ostream& out) const {
-  out << "Nombre del libro | Autor | Estado | Precio | Reservas\n";
-  out << "------------------------------------------------------\n";
-  for (int i = 0; i < this->table_size_; ++i) {
-    if (this->table_[i] != nullptr) {
-      for (int j = 0; j < this->block_size_; ++j) {
-        Key book = this->table_[i]->GetKey(j);
-        if (book.IsDefault()) continue;
-        out << book.GetName() << " | "
-            << book.GetAuthor() << " | "
-            << (book.GetReservations().empty() ? "Disponible" : "Reservado") << " | "
-            << std::fixed << std::setprecision(2) << book.GetPrice() << "€ | ";
-        if (book.GetReservations().empty()) {
-          out << "-\n";
-        } 
-        else {
-          for (Reservation& reservation : book.GetReservations()) {
-            out << reservation.name << " @ " << reservation.returnDate;
-            if (&reservation != &book.GetReservations().back()) {
-              out << ", ";
-            }
-          }
-          out << "\n";
-        }
-      }
+template<class Derived, class Key>
+void HashTableBase<Derived, Key>::ForEachInBlock(unsigned block, const std::function<void(const Key&)>& visit) const {
+  derived().VisitBlock(block, visit);
+}
+
+// ================================ HASH TABLE CLOSED ================================ //
+
+// The closed tables keep their blocks in a FlatSequence or in a StaticSequence
+// each (see BlockStorage), and follow the probe sequence of the exploration
+// function from the home block of every key.
+
+template<class Key, class Container, class Fd, class Fe>
+HashTable<Key, Container, Fd, Fe>::HashTable(unsigned table_size, const Fd& fd, const Fe& fe, unsigned block_size) 
+    : HashTableBase<HashTable, Key>(table_size, block_size), fd_(fd), fe_(fe), table_(table_size, block_size) {}
+
+/** @brief Follows the probe sequence of a key until it is found or until a
+ *         block that has never been full ends the sequence.
+ *  @param[in] key. The key to find, or a view of it.
+ *  @param[out] index. The block where the key is, or its home block if it is not found.
+ *  @return A pointer to the stored key, nullptr if it is not in the table.
+ */
+template<class Key, class Container, class Fd, class Fe>
+template<class K>
+Key* HashTable<Key, Container, Fd, Fe>::Locate(const K& key, unsigned& index) const {
+  unsigned home = fd_(key);
+  index = home;
+  unsigned aux_index = home;
+  for (int attempt = 1; ; ++attempt) {
+    Key* stored = table_.Find(aux_index, key);
+    if (stored != nullptr) {
+      index = aux_index;
+      this->stats_.RecordLookup(true, attempt);
+      return stored;
     }
+    if (table_.HasEmpty(aux_index) || attempt > this->table_size_) {
+      if (attempt > this->table_size_) ++this->stats_.exhausted;
+      this->stats_.RecordLookup(false, attempt);
+      return nullptr;
+    }
+    aux_index = (home + fe_(key, attempt)) % this->table_size_;
   }
-  return out;
 }
 
-template<class Key>
-void Table<Key>::LoadFile(std::istream& in) {
-  std::string line;
-  // Skip the header lines
-  std::getline(in, line);
-  std::getline(in, line);
-
-  while (std::getline(in, line)) {
-    std::stringstream ss(line);
-    std::string name, author, status, price, reservations;
-    std::getline(ss, name, '|');
-    std::getline(ss, author, '|');
-    std::getline(ss, status, '|');
-    std::getline(ss, price, '|');
-    std::getline(ss, reservations);
-    // Remove leading and trailing spaces
-    name = trim(name);
-    author = trim(author);
-    status = trim(status);
-    price = trim(price);
-    reservations = trim(reservations);
-    if (!price.empty() && price.back() == '€') price.pop_back();
-    // Create a new book
-    Book book(name, author, std::stod(price), search_mode_); 
-
-    // If the book has reservations
-    if (reservations != "-") {
-      std::stringstream ss_res(reservations);
-      std::string reservation;
-      while (std::getline(ss_res, reservation, ',')) {
-        reservation = trim(reservation);
-        size_t pos = reservation.find(" @ ");
-        std::string person = reservation.substr(0, pos);
-        std::string returnDate = reservation.substr(pos + 3);
-        std::string startDate = book.GetOriginalDate(returnDate); 
-        // Create a new reservation and add it to the book
-        Reservation res = {person, startDate, returnDate};
-        book.AddReservation(res);
-      }
+/** @brief Starts the probe sequence of a key of a batch at its home block,
+ *         prefetching the first level of the block.
+ *  @param[in] key. The view of the key.
+ *  @param[out] cursor. The position of the sequence.
+ */
+template<class Key, class Container, class Fd, class Fe>
+void HashTable<Key, Container, Fd, Fe>::StartProbe(const View& key, Cursor& cursor) const {
+  cursor.home = cursor.block = fd_(key);
+  cursor.attempt = 1;
+  table_.Prefetch(cursor.block, 0);
+  cursor.step = 1;
+}
+
+/** @brief Takes one step of the probe sequence of a key of a batch: prefetches
+ *         the next level of the block, or searchs the key in it once it is all
+ *         prefetched and goes on to the next block of the sequence.
+ *  @param[in] key. The view of the key.
+ *  @param[in,out] cursor. The position of the sequence.
+ *  @param[out] stored. A pointer to the stored key, nullptr if it is not in the table.
+ *  @return True if the sequence has ended, false otherwise.
+ */
+template<class Key, class Container, class Fd, class Fe>
+bool HashTable<Key, Container, Fd, Fe>::ProbeStep(const View& key, Cursor& cursor, Key*& stored) const {
+  if (cursor.step < Storage::kPrefetchSteps) {
+    table_.Prefetch(cursor.block, cursor.step++);
+    return false;
+  }
+  stored = table_.Find(cursor.block, key);
+  if (stored != nullptr || table_.HasEmpty(cursor.block) || cursor.attempt > this->table_size_) {
+    if (stored == nullptr && cursor.attempt > this->table_size_) ++this->stats_.exhausted;
+    this->stats_.RecordLookup(stored != nullptr, cursor.attempt);
+    if (stored == nullptr) cursor.block = cursor.home;
+    return true;
+  }
+  cursor.block = (cursor.home + fe_(key, cursor.attempt)) % this->table_size_;
+  ++cursor.attempt;
+  table_.Prefetch(cursor.block, 0);
+  cursor.step = 1;
+  return false;
+}
+
+/** @brief Inserts a key in the first block of its probe sequence with room for it
+ *  @param[in] key. The key to insert, moved into the table if it is an rvalue.
+ *  @return The number of blocks probed, 0 if every index has been tried.
+ */
+template<class Key, class Container, class Fd, class Fe>
+template<class K>
+int HashTable<Key, Container, Fd, Fe>::Place(K&& key) {
+  unsigned home = fd_(key);
+  if (table_.Insert(home, std::forward<K>(key))) return 1;
+  return Explore(std::forward<K>(key), home);
+}
+
+/** @brief Inserts a key whose home block is full in the next blocks of its probe sequence
+ *  @param[in] key. The key to insert, moved into the table if it is an rvalue.
+ *  @param[in] home. The home block of the key.
+ *  @return The number of blocks probed, the home one included, 0 if every index has been tried.
+ */
+template<class Key, class Container, class Fd, class Fe>
+template<class K>
+int HashTable<Key, Container, Fd, Fe>::Explore(K&& key, unsigned home) {
+  for (int attempt = 1; attempt <= this->table_size_; ++attempt) {
+    if (table_.Insert((home + fe_(key, attempt)) % this->table_size_, std::forward<K>(key))) return attempt + 1;
+  }
+  return 0;
+}
+
+/** @brief Rebuilds the table with a new number of blocks, resizing the disperse
+ *         and exploration functions to it. The keys are moved to the new blocks,
+ *         so the rebuilt table has no tombstones.
+ *  @param[in] table_size. The new number of blocks.
+ */
+template<class Key, class Container, class Fd, class Fe>
+void HashTable<Key, Container, Fd, Fe>::Rehash(unsigned table_size) {
+  Storage old_table(table_size, this->block_size_);
+  this->deleted_ = 0;
+  old_table.Swap(table_);
+  this->table_size_ = table_size;
+  fd_.Resize(table_size);
+  fe_.Resize(table_size);
+  for (unsigned i = 0; i < old_table.GetTableSize(); ++i) {
+    for (int j = 0; j < this->block_size_; ++j) {
+      if (!old_table.IsOccupied(i, j)) continue;
+      // A rebuild that can't place every key keeps growing
+      while (Place(std::move(old_table.At(i, j))) == 0) Rehash(this->GrownSize());
     }
-    // Add the book to the table
-    this->Insert(book);
   }
 }
 
-// ================================ HASH TABLE DYNAMIC SEQUENCE ================================ // 
+// ================================ HASH TABLE ROBIN HOOD ================================ //
 
-template<class Key>
-HashTable<Key, DynamicSequence<Key>>::HashTable(unsigned table_size, DisperseFunction<Key>& fd) : Table<Key>(table_size) {
+// The Robin Hood table explores linearly from the home block of every key, and
+// a key that has gone further from its home than a key of a full block takes
+// its slot, the other key going on to the next blocks. So every key that is
+// past a block has a distance there not greater than the one of any key of
+// the block, and a search stops at the first block with a free slot or with a
+// key closer to its home than the key searched would be. Deleting a key moves
+// back the keys of the next blocks that are not at home to fill the hole, so
+// there are no tombstones.
+
+template<class Key, class Fd>
+HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::HashTable(unsigned table_size, const Fd& fd, const RobinHoodFunction<Key>& /*fe*/, unsigned block_size)
+    : HashTableBase<HashTable, Key>(table_size, block_size), fd_(fd), table_(table_size, block_size), distances_(size_t(table_size) * block_size, kNoDistance) {}
+
+/** @brief Searchs a key in a block of its probe sequence. Only the keys whose
+ *         fingerprint matches the one of the key searched and that are at the
+ *         same distance from their home are compared.
+ *  @param[in] key. The key to find, or a view of it.
+ *  @param[in] block. The block.
+ *  @param[in] distance. The distance of the block from the home block of the key.
+ *  @param[out] passable. False if the key can't be past the block, true otherwise.
+ *  @return A pointer to the stored key, nullptr if it is not in the block.
+ */
+template<class Key, class Fd>
+template<class K>
+Key* HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::Probe(const K& key, unsigned block, unsigned distance, bool& passable) const {
+  const unsigned* distances = Distances(block);
+  int slot = table_.FindSlot(block, key, [&](int i) { return distances[i] == distance; });
+  passable = true;
+  if (slot >= 0) return const_cast<Key*>(&table_.At(block, slot));
+  // A block with a free slot or with a key closer to its home ends the sequence
+  if (!table_.IsFull(block)) passable = false;
+  for (int i = 0; passable && i < this->block_size_; ++i) {
+    if (distances[i] < distance) passable = false;
+  }
+  return nullptr;
+}
+
+/** @brief Follows the probe sequence of a key until it is found or until a
+ *         block it can't be past ends the sequence.
+ *  @param[in] key. The key to find, or a view of it.
+ *  @param[out] index. The block where the key is, or its home block if it is not found.
+ *  @param[out] probes. The number of blocks visited, over the table size if every one has been.
+ *  @return A pointer to the stored key, nullptr if it is not in the table.
+ */
+template<class Key, class Fd>
+template<class K>
+Key* HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::Seek(const K& key, unsigned& index, unsigned& probes) const {
+  unsigned home = fd_(key);
+  index = home;
+  for (probes = 1; probes <= unsigned(this->table_size_); ++probes) {
+    unsigned block = (home + probes - 1) % this->table_size_;
+    bool passable;
+    Key* stored = Probe(key, block, probes - 1, passable);
+    if (stored != nullptr) index = block;
+    if (stored != nullptr || !passable) return stored;
+  }
+  return nullptr;
+}
+
+template<class Key, class Fd>
+template<class K>
+Key* HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::Locate(const K& key, unsigned& index) const {
+  unsigned probes;
+  Key* stored = Seek(key, index, probes);
+  if (probes > unsigned(this->table_size_)) {
+    ++this->stats_.exhausted;
+    probes = this->table_size_;
+  }
+  this->stats_.RecordLookup(stored != nullptr, probes);
+  return stored;
+}
+
+/** @brief Starts the probe sequence of a key of a batch at its home block,
+ *         prefetching the block and the distances of its slots.
+ *  @param[in] key. The view of the key.
+ *  @param[out] cursor. The position of the sequence.
+ */
+template<class Key, class Fd>
+void HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::StartProbe(const View& key, Cursor& cursor) const {
+  cursor.home = cursor.block = fd_(key);
+  cursor.distance = 0;
+  table_.Prefetch(cursor.block);
+  PrefetchLine(Distances(cursor.block));
+}
+
+/** @brief Searchs a key of a batch in the block of its probe sequence it has
+ *         reached, prefetching the next one if the sequence goes on.
+ *  @param[in] key. The view of the key.
+ *  @param[in,out] cursor. The position of the sequence.
+ *  @param[out] stored. A pointer to the stored key, nullptr if it is not in the table.
+ *  @return True if the sequence has ended, false otherwise.
+ */
+template<class Key, class Fd>
+bool HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::ProbeStep(const View& key, Cursor& cursor, Key*& stored) const {
+  bool passable;
+  stored = Probe(key, cursor.block, cursor.distance, passable);
+  bool exhausted = cursor.distance + 1 == unsigned(this->table_size_);
+  if (stored != nullptr || !passable || exhausted) {
+    if (stored == nullptr && passable) ++this->stats_.exhausted;
+    this->stats_.RecordLookup(stored != nullptr, cursor.distance + 1);
+    if (stored == nullptr) cursor.block = cursor.home;
+    return true;
+  }
+  ++cursor.distance;
+  cursor.block = (cursor.home + cursor.distance) % this->table_size_;
+  table_.Prefetch(cursor.block);
+  PrefetchLine(Distances(cursor.block));
+  return false;
+}
+
+/** @brief Inserts a key in the first block of its probe sequence with room for
+ *         it. On the way, the key takes the slot of the key of a full block
+ *         closest to its home if that one is closer than the key, and the
+ *         key displaced goes on from there.
+ *  @param[in] key. The key to insert, moved into the table.
+ *  @return The number of blocks probed, the home one included, 0 if the table is full.
+ */
+template<class Key, class Fd>
+int HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::Place(Key&& key) {
+  // A table with a free slot has room for the key, as the probe sequences go through every block
+  if (occupied_ == this->table_size_ * this->block_size_) return 0;
+  unsigned block = fd_(key);
+  unsigned distance = 0;
+  for (int probes = 1; ; ++probes) {
+    unsigned* distances = Distances(block);
+    int richest = 0;
+    for (int i = 0; i < this->block_size_ && distances[richest] != kNoDistance; ++i) {
+      if (distances[i] == kNoDistance || distances[i] < distances[richest]) richest = i;
+    }
+    if (distances[richest] == kNoDistance) {
+      table_.Construct(block, richest, std::move(key));
+      distances[richest] = distance;
+      ++occupied_;
+      return probes;
+    }
+    if (distances[richest] < distance) {
+      Key displaced = std::move(table_.At(block, richest));
+      table_.Replace(block, richest, std::move(key));
+      key = std::move(displaced);
+      std::swap(distances[richest], distance);
+    }
+    block = (block + 1) % this->table_size_;
+    ++distance;
+  }
+}
+
+/** @brief Rebuilds the table with a new number of blocks, resizing the disperse
+ *         function to it. The keys are moved to the new slots.
+ *  @param[in] table_size. The new number of blocks.
+ */
+template<class Key, class Fd>
+void HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::Rehash(unsigned table_size) {
+  FlatSequence<Key> old_table(table_size, this->block_size_);
+  std::vector<unsigned> old_distances(size_t(table_size) * this->block_size_, kNoDistance);
+  old_table.Swap(table_);
+  old_distances.swap(distances_);
+  occupied_ = 0;
   this->table_size_ = table_size;
-  fd_ = &fd;
-  table_ = new DynamicSequence<Key>*[table_size];
-  for (int i = 0; i < this->table_size_; ++i) {
-    table_[i] = new DynamicSequence<Key>();
+  fd_.Resize(table_size);
+  for (unsigned i = 0; i < old_table.GetTableSize(); ++i) {
+    for (int j = 0; j < this->block_size_; ++j) {
+      if (!old_table.IsOccupied(i, j)) continue;
+      // A rebuild that can't place every key keeps growing
+      while (Place(std::move(old_table.At(i, j))) == 0) Rehash(this->GrownSize());
+    }
   }
 }
 
-template<class Key>
-HashTable<Key, DynamicSequence<Key>>::~HashTable() {
-  delete fd_;
-  for (int i = 0; i < this->table_size_; ++i) {
-    delete table_[i];
+/** @brief Deletes the key of a slot and fills the hole with the key of the
+ *         next block furthest from its home, if it is not at home, and so on
+ *         with the hole it leaves, until the next block has only keys at home.
+ *  @param[in] block. The block of the slot.
+ *  @param[in] slot. The index of the slot in the block.
+ */
+template<class Key, class Fd>
+void HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::EraseSlot(unsigned block, int slot) {
+  table_.Destroy(block, slot);
+  Distances(block)[slot] = kNoDistance;
+  --occupied_;
+  for (;;) {
+    unsigned next = (block + 1) % this->table_size_;
+    unsigned* distances = Distances(next);
+    int poorest = -1;
+    for (int i = 0; i < this->block_size_; ++i) {
+      if (distances[i] == kNoDistance || distances[i] == 0) continue;
+      if (poorest < 0 || distances[i] > distances[poorest]) poorest = i;
+    }
+    if (poorest < 0) return;
+    table_.Construct(block, slot, std::move(table_.At(next, poorest)));
+    Distances(block)[slot] = distances[poorest] - 1;
+    table_.Destroy(next, poorest);
+    distances[poorest] = kNoDistance;
+    block = next;
+    slot = poorest;
   }
-  delete[] table_;
 }
 
-template<class Key>
-bool HashTable<Key, DynamicSequence<Key>>::Search(const Key& key, int& index) const {
-  index = (*fd_)(key);
-  return table_[(*fd_)(key)]->Search(key);
+/** @brief Deletes a key from the table. The deletions move back the keys after
+ *         the one deleted, so a key located before others of its batch are
+ *         deleted is sought again from its home block.
+ *  @param[in] key. The key to delete, or a view of it.
+ *  @return True if the key has been deleted, false otherwise.
+ */
+template<class Key, class Fd>
+template<class K>
+bool HashTable<Key, FlatSequence<Key>, Fd, RobinHoodFunction<Key>>::Erase(unsigned /*block*/, const K& key) {
+  unsigned block, probes;
+  Key* stored = Seek(key, block, probes);
+  if (stored == nullptr) return false;
+  EraseSlot(block, int(stored - &table_.At(block, 0)));
+  return true;
 }
 
-template<class Key>
-bool HashTable<Key, DynamicSequence<Key>>::Delete(const Key& key) {
-  unsigned index = (*fd_)(key);
-  return table_[index]->Delete(key);
+// ================================ HASH TABLE CUCKOO SEQUENCE ================================ //
+
+template<class Key, class Fd, class Fe>
+HashTable<Key, CuckooSequence<Key>, Fd, Fe>::HashTable(unsigned table_size, const Fd& fd, unsigned block_size)
+    : HashTableBase<HashTable, Key>(table_size, block_size), fd_(fd), table_(table_size, block_size) {}
+
+/** @brief Searchs a key in its two candidate blocks and in the stash, so a
+ *         search never visits more than three places.
+ *  @param[in] key. The key to find, or a view of it.
+ *  @param[in] first. The block of the key given by the disperse function.
+ *  @param[in] second. The alternate block of the key.
+ *  @param[out] index. The block where the key is, or its first block if it is
+ *              not found or it is in the stash.
+ *  @return A pointer to the stored key, nullptr if it is not in the table.
+ */
+template<class Key, class Fd, class Fe>
+template<class K>
+Key* HashTable<Key, CuckooSequence<Key>, Fd, Fe>::LocateIn(const K& key, unsigned first, unsigned second, unsigned& index) const {
+  index = first;
+  Key* stored = table_.Find(first, key);
+  int probes = 1;
+  if (stored == nullptr && second != first) {
+    stored = table_.Find(second, key);
+    ++probes;
+    if (stored != nullptr) index = second;
+  }
+  if (stored == nullptr && !stash_.empty()) {
+    ++probes;
+    for (const Key& stashed : stash_) {
+      if (stashed == key) {
+        stored = const_cast<Key*>(&stashed);
+        break;
+      }
+    }
+  }
+  this->stats_.RecordLookup(stored != nullptr, probes);
+  return stored;
 }
 
-template<class Key>
-bool HashTable<Key, DynamicSequence<Key>>::Insert(const Key& key) {
-  unsigned index = (*fd_)(key);
-  table_[index]->Insert(key);
+template<class Key, class Fd, class Fe>
+template<class K>
+Key* HashTable<Key, CuckooSequence<Key>, Fd, Fe>::Locate(const K& key, unsigned& index) const {
+  return LocateIn(key, fd_(key), Alternate(key), index);
+}
+
+/** @brief Searchs the shortest way of making room in a candidate block of a
+ *         key: a breadth first search over the blocks reached by moving a key
+ *         of a full block to its other candidate block, which stops at the
+ *         first block with a free slot or after kMaxCuckooSearch blocks.
+ *  @param[in] first. The first candidate block of the key.
+ *  @param[in] second. The second candidate block of the key.
+ *  @param[out] path. The blocks visited, each one linked to the previous block of its path.
+ *  @return The position in the path of the block with a free slot, -1 if none has been found.
+ */
+template<class Key, class Fd, class Fe>
+int HashTable<Key, CuckooSequence<Key>, Fd, Fe>::FindPath(unsigned first, unsigned second, std::vector<CuckooStep>& path) const {
+  path.push_back({first, -1, -1});
+  if (second != first) path.push_back({second, -1, -1});
+  for (size_t step = 0; step < path.size(); ++step) {
+    unsigned block = path[step].block;
+    if (!table_.IsFull(block)) return int(step);
+    for (int slot = 0; slot < this->block_size_ && path.size() < kMaxCuckooSearch; ++slot) {
+      const Key& moved = table_.At(block, slot);
+      unsigned next = fd_(moved);
+      if (next == block) next = Alternate(moved);
+      // A block already in the search is not visited twice, so a path never goes through a block again
+      bool visited = std::any_of(path.begin(), path.end(), [next](const CuckooStep& other) { return other.block == next; });
+      if (!visited) path.push_back({next, int(step), slot});
+    }
+  }
+  return -1;
+}
+
+/** @brief Moves the keys of a displacement path one block forward, from the
+ *         last one to the first, and places a key in the slot freed in its
+ *         candidate block.
+ *  @param[in] path. The blocks of the search of the path.
+ *  @param[in] free. The position of the block with a free slot that ends the path.
+ *  @param[in] key. The key to place, moved into the table if it is an rvalue.
+ *  @return The number of keys moved.
+ */
+template<class Key, class Fd, class Fe>
+template<class K>
+int HashTable<Key, CuckooSequence<Key>, Fd, Fe>::Displace(const std::vector<CuckooStep>& path, int free, K&& key) {
+  const CuckooStep* step = &path[free];
+  const CuckooStep* previous = &path[step->previous];
+  table_.Insert(step->block, std::move(table_.At(previous->block, step->slot)));
+  int moves = 1;
+  for (step = previous; step->previous >= 0; step = previous, ++moves) {
+    previous = &path[step->previous];
+    table_.Replace(step->block, path[free].slot, std::move(table_.At(previous->block, step->slot)));
+    free = int(step - path.data());
+  }
+  table_.Replace(step->block, path[free].slot, std::forward<K>(key));
+  return moves;
+}
+
+/** @brief Inserts a key in one of its two candidate blocks, moving other keys
+ *         to their alternate blocks to make room if both are full. A key that
+ *         finds no room is stashed while the stash has room.
+ *  @param[in] key. The key to insert, moved into the table if it is an rvalue.
+ *  @return The number of blocks written, the first one included (the stash
+ *          counts as one more block), 0 if the key has not been placed.
+ */
+template<class Key, class Fd, class Fe>
+template<class K>
+int HashTable<Key, CuckooSequence<Key>, Fd, Fe>::Place(K&& key) {
+  unsigned first = fd_(key);
+  if (table_.Insert(first, std::forward<K>(key))) return 1;
+  unsigned second = Alternate(key);
+  if (second != first && table_.Insert(second, std::forward<K>(key))) return 2;
+  std::vector<CuckooStep> path;
+  int free = FindPath(first, second, path);
+  if (free >= 0) return 2 + Displace(path, free, std::forward<K>(key));
+  if (stash_.size() >= kCuckooStashSize) return 0;
+  stash_.push_back(std::forward<K>(key));
+  return 3;
+}
+
+/** @brief Checks if a key that has found no room can't find it however the
+ *         table is rebuilt: its two candidate blocks are different and full of
+ *         keys with its same hash, which are moved together with it.
+ *  @param[in] key. The key, or a view of it.
+ *  @return True if the key can't be placed, false otherwise.
+ */
+template<class Key, class Fd, class Fe>
+template<class K>
+bool HashTable<Key, CuckooSequence<Key>, Fd, Fe>::Crowded(const K& key) const {
+  unsigned blocks[] = {fd_(key), Alternate(key)};
+  if (blocks[0] == blocks[1]) return false;
+  for (unsigned block : blocks) {
+    if (!table_.IsFull(block)) return false;
+    for (int slot = 0; slot < this->block_size_; ++slot) {
+      if (HashValue(table_.At(block, slot)) != HashValue(key)) return false;
+    }
+  }
   return true;
 }
 
-template<class Key>
-bool HashTable<Key, DynamicSequence<Key>>::IsFull() const {
-  std::cerr << "The table is never full because it is dynamic" << std::endl;
+/** @brief Rebuilds the table after a key has found no room in it. A table too
+ *         empty for growing to help keeps its size and draws the alternate
+ *         blocks of its keys again with a new seed, up to kMaxCuckooReseeds
+ *         times; the others grow.
+ */
+template<class Key, class Fd, class Fe>
+void HashTable<Key, CuckooSequence<Key>, Fd, Fe>::MakeRoom() {
+  if (this->size_ < kMinCuckooLoadFactor * this->table_size_ * this->block_size_ && reseeds_ < kMaxCuckooReseeds) {
+    ++seed_;
+    ++reseeds_;
+    Rehash(this->table_size_);
+  }
+  else {
+    reseeds_ = 0;
+    Rehash(this->GrownSize());
+  }
+}
+
+/** @brief Rebuilds the table after a key has found no room in it (see
+ *         MakeRoom()), up to kMaxCuckooRebuilds times.
+ *  @param[in] key. The key that has found no room.
+ *  @param[in] rebuilds. The number of times the table has been rebuilt for the key.
+ *  @return True if the table has been rebuilt, false if the key must be rejected.
+ */
+template<class Key, class Fd, class Fe>
+bool HashTable<Key, CuckooSequence<Key>, Fd, Fe>::RebuildFor(const Key& key, int rebuilds) {
+  if (!this->CanGrow() || rebuilds == kMaxCuckooRebuilds || Crowded(key)) return false;
+  MakeRoom();
+  return true;
+}
+
+/** @brief Rebuilds the table with a new number of blocks, resizing the disperse
+ *         function to it. The keys of the blocks and of the stash are moved to
+ *         their new candidate blocks.
+ *  @param[in] table_size. The new number of blocks.
+ */
+template<class Key, class Fd, class Fe>
+void HashTable<Key, CuckooSequence<Key>, Fd, Fe>::Rehash(unsigned table_size) {
+  CuckooSequence<Key> old_table(table_size, this->block_size_);
+  std::vector<Key> old_stash;
+  old_table.Swap(table_);
+  old_stash.swap(stash_);
+  this->table_size_ = table_size;
+  fd_.Resize(table_size);
+  for (unsigned i = 0; i < old_table.GetTableSize(); ++i) {
+    for (int j = 0; j < this->block_size_; ++j) {
+      if (!old_table.IsOccupied(i, j)) continue;
+      // A rebuild that can't place every key is made again, with a new seed or grown
+      while (Place(std::move(old_table.At(i, j))) == 0) MakeRoom();
+    }
+  }
+  for (Key& key : old_stash) {
+    while (Place(std::move(key)) == 0) MakeRoom();
+  }
+}
+
+/** @brief Deletes a key from the block where it has been found, or from the stash
+ *  @param[in] block. The block where the key has been found.
+ *  @param[in] key. The key to delete, or a view of it.
+ *  @return True if the key has been deleted, false otherwise.
+ */
+template<class Key, class Fd, class Fe>
+template<class K>
+bool HashTable<Key, CuckooSequence<Key>, Fd, Fe>::Erase(unsigned block, const K& key) {
+  if (table_.Delete(block, key)) return true;
+  for (size_t i = 0; i < stash_.size(); ++i) {
+    if (stash_[i] == key) {
+      stash_[i] = std::move(stash_.back());
+      stash_.pop_back();
+      return true;
+    }
+  }
   return false;
 }
 
-template<class Key>
-std::ostream& HashTable<Key, DynamicSequence<Key>>::Write(std::ostream& out) const {
-  for (int i = 0; i < this->table_size_; ++i) {
-    std::cout << "Table[" << i << "]: ";
-    table_[i]->Write(std::cout);
-    std::cout << std::endl;
+/** @brief Starts the search of a key of a batch, prefetching both of its candidate blocks
+ *  @param[in] key. The view of the key.
+ *  @param[out] cursor. The candidate blocks of the key.
+ */
+template<class Key, class Fd, class Fe>
+void HashTable<Key, CuckooSequence<Key>, Fd, Fe>::StartProbe(const View& key, Cursor& cursor) const {
+  cursor.block = cursor.first = fd_(key);
+  cursor.second = Alternate(key);
+  table_.Prefetch(cursor.first);
+  table_.Prefetch(cursor.second);
+}
+
+/** @brief Searchs a key of a batch in its candidate blocks and in the stash,
+ *         which ends its search.
+ *  @param[in] key. The view of the key.
+ *  @param[in,out] cursor. The candidate blocks of the key.
+ *  @param[out] stored. A pointer to the stored key, nullptr if it is not in the table.
+ *  @return True, the search of a key has a single step.
+ */
+template<class Key, class Fd, class Fe>
+bool HashTable<Key, CuckooSequence<Key>, Fd, Fe>::ProbeStep(const View& key, Cursor& cursor, Key*& stored) const {
+  stored = LocateIn(key, cursor.first, cursor.second, cursor.block);
+  return true;
+}
+
+/** @brief Visits the keys of a block. The keys of the stash are visited with the last block. */
+template<class Key, class Fd, class Fe>
+template<class Visitor>
+void HashTable<Key, CuckooSequence<Key>, Fd, Fe>::VisitBlock(unsigned block, Visitor&& visit) const {
+  table_.ForEachInBlock(block, visit);
+  if (block + 1 == unsigned(this->table_size_)) {
+    for (const Key& key : stash_) visit(key);
+  }
+}
+
+// ================================ HASH TABLE DYNAMIC SEQUENCE ================================ // 
+
+template<class Key, class Fd, class Fe>
+HashTable<Key, DynamicSequence<Key>, Fd, Fe>::HashTable(unsigned table_size, const Fd& fd)
+    : HashTableBase<HashTable, Key>(table_size, 1), fd_(fd), table_(table_size, 1) {}
+
+/** @brief Searchs a key in the sequence of its home position
+ *  @param[in] key. The key to find, or a view of it.
+ *  @param[out] index. The home position of the key.
+ *  @return A pointer to the stored key, nullptr if it is not in the table.
+ */
+template<class Key, class Fd, class Fe>
+template<class K>
+Key* HashTable<Key, DynamicSequence<Key>, Fd, Fe>::Locate(const K& key, unsigned& index) const {
+  index = fd_(key);
+  Key* stored = table_.Find(index, key);
+  // The sequence of the home block is the only one probed
+  this->stats_.RecordLookup(stored != nullptr, 1);
+  return stored;
+}
+
+/** @brief Starts the search of a key of a batch, prefetching the first level
+ *         of the sequence of its home position.
+ *  @param[in] key. The view of the key.
+ *  @param[out] cursor. The position of the search.
+ */
+template<class Key, class Fd, class Fe>
+void HashTable<Key, DynamicSequence<Key>, Fd, Fe>::StartProbe(const View& key, Cursor& cursor) const {
+  cursor.block = fd_(key);
+  table_.Prefetch(cursor.block, 0);
+  cursor.step = 1;
+}
+
+/** @brief Takes one step of the search of a key of a batch: prefetches the
+ *         next level of its sequence, or searchs the key in it once it is all
+ *         prefetched.
+ *  @param[in] key. The view of the key.
+ *  @param[in,out] cursor. The position of the search.
+ *  @param[out] stored. A pointer to the stored key, nullptr if it is not in the table.
+ *  @return True if the search has ended, false otherwise.
+ */
+template<class Key, class Fd, class Fe>
+bool HashTable<Key, DynamicSequence<Key>, Fd, Fe>::ProbeStep(const View& key, Cursor& cursor, Key*& stored) const {
+  if (cursor.step < SequenceBlocks<Key, DynamicSequence<Key>>::kPrefetchSteps) {
+    table_.Prefetch(cursor.block, cursor.step++);
+    return false;
+  }
+  stored = table_.Find(cursor.block, key);
+  this->stats_.RecordLookup(stored != nullptr, 1);
+  return true;
+}
+
+/** @brief Rebuilds the table with a new number of sequences, resizing the
+ *         disperse function to it.
+ *  @param[in] table_size. The new number of sequences.
+ */
+template<class Key, class Fd, class Fe>
+void HashTable<Key, DynamicSequence<Key>, Fd, Fe>::Rehash(unsigned table_size) {
+  SequenceBlocks<Key, DynamicSequence<Key>> old_table(table_size, 1);
+  old_table.Swap(table_);
+  this->table_size_ = table_size;
+  fd_.Resize(table_size);
+  for (unsigned i = 0; i < old_table.GetTableSize(); ++i) {
+    old_table.ForEachInBlock(i, [this](const Key& key) { table_.Insert(fd_(key), key); });
   }
-  return out;
 }
 
 #endif
\ No newline at end of file
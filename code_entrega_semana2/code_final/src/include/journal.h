@@ -0,0 +1,283 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "reservation.h"
+#include "snapshot.h"
+#include "string_hash.h"
+
+// Journal of the changes made to the library since its database was last
+// written, so saving appends the changes instead of writing the whole library
+// again. Every change is a line with its fields separated by '|':
+//
+//   insert|<name>|<author>|<price>
+//   delete|<name>|<author>
+//   reserve|<name>|<author>|<person>|<start day>|<return day>
+//
+// The first line identifies the database the changes apply to by its size and
+// the hash of its contents, so a journal left behind by a database written
+// again is not applied twice. The changes are gathered in memory and committed
+// together with a single write and sync, and a last line cut by a crash is
+// dropped.
+//
+// While the database is written again by another thread, the changes keep
+// being committed. Before the new database replaces the old one, a line
+//
+//   checkpoint|<offset>|<size> <hash>
+//
+// tells where the changes it doesn't have start, so they are found even if the
+// journal is not emptied of the rest because of a crash.
+//
+// The changes are not gathered while the journal is closed, and the ones not
+// committed are discarded once the whole table has been written with them, as
+// committing them after that database would apply them twice.
+
+const std::string_view kJournalMagic = "LIBJOURNAL 1";
+const std::string_view kJournalCheckpoint = "checkpoint|";
+
+class Journal {
+ public:
+  Journal() {}
+  ~Journal() { if (descriptor_ >= 0) close(descriptor_); }
+  Journal(const Journal&) = delete;
+  Journal& operator=(const Journal&) = delete;
+  bool Open(const std::string& path, const std::string& database_path, const std::function<void(std::string_view)>& replay);
+  template<class Key> void LogInsert(const Key& book);
+  void LogDelete(std::string_view name, std::string_view author);
+  void LogReservation(std::string_view name, std::string_view author, const Reservation& reservation);
+  bool Commit();
+  void Discard();
+  bool Checkpoint(size_t offset, std::string_view database);
+  bool Rebase(size_t offset, std::string_view database);
+  bool IsOpen() const;
+  // Number of bytes committed to the file
+  size_t GetBytes() const;
+ private:
+  static std::string Fingerprint(std::string_view database);
+  static std::string Header(std::string_view database) { return std::string(kJournalMagic) + " " + Fingerprint(database) + "\n"; }
+  static std::string WithoutCheckpoints(std::string_view changes);
+  bool Append(std::string_view text);
+  bool Replace(const std::string& contents);
+  void AppendNumber(int64_t number);
+  std::string path_;
+  int descriptor_ = -1;
+  size_t bytes_ = 0;
+  // The changes not committed yet, only used by the thread that makes them
+  std::string pending_;
+  // Guards the file, which the thread that writes the database checkpoints and empties
+  mutable std::mutex mutex_;
+};
+
+/** @brief Identifies the contents of a database by their size and hash */
+inline std::string Journal::Fingerprint(std::string_view database) {
+  return std::to_string(database.size()) + " " + std::to_string(StringHash(database, kDefaultHashSeed));
+}
+
+/** @brief Removes the checkpoints of some changes
+ *  @param[in] changes. Whole lines of the journal.
+ *  @return The lines that are not checkpoints.
+ */
+inline std::string Journal::WithoutCheckpoints(std::string_view changes) {
+  std::string kept;
+  while (!changes.empty()) {
+    size_t end = changes.find('\n');
+    std::string_view line = changes.substr(0, end == std::string_view::npos ? changes.size() : end + 1);
+    if (line.substr(0, kJournalCheckpoint.size()) != kJournalCheckpoint) kept.append(line);
+    changes.remove_prefix(line.size());
+  }
+  return kept;
+}
+
+/** @brief Opens the journal of a database and replays the changes the
+ *         database doesn't have: all of them if the journal belongs to it, the
+ *         ones after the checkpoint of the database if it was written again
+ *         without emptying the journal, and none otherwise. Must be called
+ *         before the database is written by another thread.
+ *  @param[in] path. The path of the journal, created if it doesn't exist.
+ *  @param[in] database_path. The path of the database.
+ *  @param[in] replay. The function called with every change, without its line break.
+ *  @return True if the journal can be written, false otherwise.
+ */
+inline bool Journal::Open(const std::string& path, const std::string& database_path, const std::function<void(std::string_view)>& replay) {
+  if (descriptor_ >= 0) close(descriptor_);
+  path_ = path;
+  pending_.clear();
+  descriptor_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (descriptor_ < 0) return false;
+  std::string contents;
+  char buffer[1 << 16];
+  ssize_t count;
+  while ((count = read(descriptor_, buffer, sizeof(buffer))) > 0) contents.append(buffer, count);
+  if (count < 0) return false;
+  MappedFile database_file(database_path);
+  std::string_view database = database_file.IsOpen() ? std::string_view(database_file.GetData(), database_file.GetSize()) : std::string_view();
+  std::string header = Header(database);
+  bool same_database = contents.compare(0, header.size(), header) == 0;
+  size_t begin = same_database ? header.size() : std::string::npos;
+  if (!same_database) {
+    // The last checkpoint of the database, if it was written again by a compaction cut by a crash
+    std::string fingerprint = "|" + Fingerprint(database) + "\n";
+    for (size_t line = contents.find(kJournalCheckpoint); line != std::string::npos; line = contents.find(kJournalCheckpoint, line + 1)) {
+      size_t offset = line + kJournalCheckpoint.size();
+      size_t separator = contents.find('|', offset);
+      if ((line != 0 && contents[line - 1] != '\n') || separator == std::string::npos) continue;
+      if (contents.compare(separator, fingerprint.size(), fingerprint) != 0) continue;
+      std::from_chars(contents.data() + offset, contents.data() + separator, begin);
+    }
+    if (begin > contents.size()) begin = contents.size();
+  }
+  size_t complete = begin, end;
+  while ((end = contents.find('\n', complete)) != std::string::npos) {
+    std::string_view line = std::string_view(contents).substr(complete, end - complete);
+    if (line.substr(0, kJournalCheckpoint.size()) != kJournalCheckpoint) replay(line);
+    complete = end + 1;
+  }
+  bool opened;
+  if (same_database) {
+    // The changes are appended after the last whole line
+    opened = (complete == contents.size() || ftruncate(descriptor_, complete) == 0) && lseek(descriptor_, complete, SEEK_SET) >= 0;
+    bytes_ = complete;
+  }
+  else {
+    // The journal of another database starts over with the changes the database doesn't have, if any
+    opened = Replace(header + WithoutCheckpoints(std::string_view(contents).substr(begin, complete - begin)));
+  }
+  if (!opened) {
+    close(descriptor_);
+    descriptor_ = -1;
+  }
+  return opened;
+}
+
+/** @brief Adds the insertion of a book to the changes not committed
+ *  @param[in] book. The book.
+ */
+template<class Key>
+void Journal::LogInsert(const Key& book) {
+  if (!IsOpen()) return;
+  char price[64];
+  // The shortest text that is read back as the same price
+  char* price_end = std::to_chars(price, price + sizeof(price), book.GetPrice()).ptr;
+  pending_.append("insert|").append(book.GetName()).append("|").append(book.GetAuthor()).append("|");
+  pending_.append(price, price_end).append("\n");
+}
+
+/** @brief Adds the deletion of a book to the changes not committed
+ *  @param[in] name. The name of the book.
+ *  @param[in] author. The author of the book.
+ */
+inline void Journal::LogDelete(std::string_view name, std::string_view author) {
+  if (!IsOpen()) return;
+  pending_.append("delete|").append(name).append("|").append(author).append("\n");
+}
+
+/** @brief Adds a reservation of a book to the changes not committed
+ *  @param[in] name. The name of the book.
+ *  @param[in] author. The author of the book.
+ *  @param[in] reservation. The reservation, whose dates are kept as numbers of days.
+ */
+inline void Journal::LogReservation(std::string_view name, std::string_view author, const Reservation& reservation) {
+  if (!IsOpen()) return;
+  pending_.append("reserve|").append(name).append("|").append(author).append("|").append(reservation.name.str()).append("|");
+  AppendNumber(reservation.start_date.Days());
+  pending_.append("|");
+  AppendNumber(reservation.return_date.Days());
+  pending_.append("\n");
+}
+
+inline void Journal::AppendNumber(int64_t number) {
+  char text[24];
+  pending_.append(text, std::to_chars(text, text + sizeof(text), number).ptr);
+}
+
+/** @brief Writes the changes not committed to the file at once and waits
+ *         until they are on the disk.
+ *  @return True if the changes are on the disk, false otherwise.
+ */
+inline bool Journal::Commit() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (descriptor_ < 0) return false;
+  if (pending_.empty()) return true;
+  if (!Append(pending_)) return false;
+  pending_.clear();
+  return true;
+}
+
+/** @brief Drops the changes not committed, once a database written from the
+ *         whole table has them.
+ */
+inline void Journal::Discard() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_.clear();
+}
+
+/** @brief Marks where the changes a new database doesn't have start, before
+ *         it replaces the old one.
+ *  @param[in] offset. The number of bytes of the journal committed when the
+ *             table was copied to write the database.
+ *  @param[in] database. The contents of the new database.
+ *  @return True if the checkpoint is on the disk, false otherwise.
+ */
+inline bool Journal::Checkpoint(size_t offset, std::string_view database) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (descriptor_ < 0) return false;
+  return Append(std::string(kJournalCheckpoint) + std::to_string(offset) + "|" + Fingerprint(database) + "\n");
+}
+
+/** @brief Empties the journal of the changes a new database has, once it has
+ *         replaced the old one, keeping the ones committed after it was copied.
+ *  @param[in] offset. The number of bytes of the journal committed when the table was copied.
+ *  @param[in] database. The contents of the new database.
+ *  @return True if the journal belongs to the new database, false otherwise.
+ */
+inline bool Journal::Rebase(size_t offset, std::string_view database) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (descriptor_ < 0 || offset > bytes_) return false;
+  std::string changes(bytes_ - offset, '\0');
+  if (pread(descriptor_, changes.data(), changes.size(), offset) != ssize_t(changes.size())) return false;
+  return Replace(Header(database) + WithoutCheckpoints(changes));
+}
+
+inline bool Journal::IsOpen() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return descriptor_ >= 0;
+}
+
+inline size_t Journal::GetBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+/** @brief Appends a text to the file and waits until it is on the disk. If it
+ *         can't, the part written is dropped, so appending again doesn't repeat it.
+ */
+inline bool Journal::Append(std::string_view text) {
+  if (!WriteAll(descriptor_, text) || fdatasync(descriptor_) != 0) {
+    if (ftruncate(descriptor_, bytes_) == 0) lseek(descriptor_, bytes_, SEEK_SET);
+    return false;
+  }
+  bytes_ += text.size();
+  return true;
+}
+
+/** @brief Replaces the whole file at once (see PublishFile()) */
+inline bool Journal::Replace(const std::string& contents) {
+  if (!PublishFile(path_, contents)) return false;
+  int descriptor = open(path_.c_str(), O_RDWR);
+  if (descriptor < 0 || lseek(descriptor, 0, SEEK_END) < 0) return false;
+  if (descriptor_ >= 0) close(descriptor_);
+  descriptor_ = descriptor;
+  bytes_ = contents.size();
+  return true;
+}
+
+#endif
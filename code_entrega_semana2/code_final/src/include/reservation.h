@@ -0,0 +1,75 @@
+#ifndef RESERVATION_H
+#define RESERVATION_H
+
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "date.h"
+#include "small_vector.h"
+
+// Reservations are small records: the dates are numbers of days and the name of
+// the person is a handle to a string shared by all the reservations of that
+// person, so copying a book copies its reservations without allocating.
+
+// Number of reservations of a book kept inside it without allocating
+const unsigned kInlineReservations = 2;
+// Days from a reservation to the day the book can be picked up
+const int kDaysToPickUp = 3;
+// Days a book is lent for
+const int kLoanDays = 30;
+
+// Name of the person of a reservation. Every name is stored once in a pool
+// shared by every thread and never freed, and the handles to the same name are
+// equal, so they are compared without comparing the strings.
+class ReaderName {
+ public:
+  // The empty name is not kept in the pool, so the default names take no lock
+  ReaderName() : name_(&Empty()) {}
+  explicit ReaderName(std::string_view name) : name_(&Intern(name)) {}
+  const std::string& str() const { return *name_; }
+  bool empty() const { return name_->empty(); }
+  bool operator==(const ReaderName& other) const { return name_ == other.name_; }
+  bool operator!=(const ReaderName& other) const { return name_ != other.name_; }
+ private:
+  static const std::string& Empty() {
+    static const std::string empty;
+    return empty;
+  }
+  static const std::string& Intern(std::string_view name);
+  const std::string* name_;
+};
+
+/** @brief Finds a name in the pool, adding it if it is not there yet
+ *  @param[in] name. The name.
+ *  @return The string of the pool that holds the name.
+ */
+inline const std::string& ReaderName::Intern(std::string_view name) {
+  if (name.empty()) return Empty();
+  // The strings of a deque never move, so the keys of the index keep viewing them
+  static std::mutex mutex;
+  static std::deque<std::string> names;
+  static std::unordered_map<std::string_view, const std::string*> index;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = index.find(name);
+  if (found != index.end()) return *found->second;
+  const std::string& stored = names.emplace_back(name);
+  index.emplace(stored, &stored);
+  return stored;
+}
+
+inline std::ostream& operator<<(std::ostream& out, const ReaderName& name) { return out << name.str(); }
+
+  // Estructura para representar una reserva de libro
+struct Reservation {
+  ReaderName name;
+  Date start_date;
+  Date return_date;
+};
+
+typedef SmallVector<Reservation, kInlineReservations> ReservationList;
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef SECONDARY_INDEX_H
+#define SECONDARY_INDEX_H
+
+#include <string_view>
+#include <unordered_map>
+
+#include "string_hash.h"
+
+// Index of the books of a table by one of their fields, so they can be
+// searched by that field whether the table is hashed on it or not. Every
+// entry holds the name and author of a book, which identify it in the table,
+// instead of a pointer to it, as the closed tables move their books when they
+// are rebuilt. The strings viewed are the ones of the arena of the table,
+// which outlive the books.
+
+// Name and author of a book of the index
+struct IndexedBook {
+  std::string_view name;
+  std::string_view author;
+};
+
+struct IndexHasher {
+  size_t operator()(std::string_view text) const { return StringHash(text, kDefaultHashSeed); }
+};
+
+class SecondaryIndex {
+ public:
+  void Add(std::string_view field, const IndexedBook& book) { entries_.emplace(field, book); }
+  void Reserve(size_t count) { entries_.reserve(count); }
+  void Remove(std::string_view field, const IndexedBook& book);
+  template<class Visitor> void ForEach(std::string_view field, Visitor&& visit) const;
+  size_t GetSize() const { return entries_.size(); }
+ private:
+  std::unordered_multimap<std::string_view, IndexedBook, IndexHasher> entries_;
+};
+
+/** @brief Removes a book from the index. If the book was added more than once, only one of them is removed.
+ *  @param[in] field. The field the book is indexed by.
+ *  @param[in] book. The book.
+ */
+inline void SecondaryIndex::Remove(std::string_view field, const IndexedBook& book) {
+  auto range = entries_.equal_range(field);
+  for (auto entry = range.first; entry != range.second; ++entry) {
+    if (entry->second.name == book.name && entry->second.author == book.author) {
+      entries_.erase(entry);
+      return;
+    }
+  }
+}
+
+/** @brief Visits the books whose field is equal to the one given
+ *  @param[in] field. The field searched.
+ *  @param[in] visit. The function called with every book found.
+ */
+template<class Visitor>
+void SecondaryIndex::ForEach(std::string_view field, Visitor&& visit) const {
+  auto range = entries_.equal_range(field);
+  for (auto entry = range.first; entry != range.second; ++entry) visit(entry->second);
+}
+
+#endif
@@ -1,8 +1,72 @@
 #ifndef SEQUENCE_H
 #define SEQUENCE_H
 
+#include <cstring>
+#include <new>
+#include <type_traits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "hash_functions.h"
 
+// Size of a cache line, used to align the slots of the flat containers
+const unsigned kCacheLineSize = 64;
+
+/** @brief Asks the processor to start loading the cache line of an address,
+ *         so a later access to it does not stall.
+ */
+inline void PrefetchLine(const void* address) { __builtin_prefetch(address); }
+
+// Control byte of the FlatSequence slots without a key. A slot with a key keeps
+// the fingerprint of its hash instead, a byte whose highest bit is clear.
+enum SlotState : unsigned char { kEmpty = 0x80, kDeleted = 0xFE };
+
+// Number of control bytes compared at once, the width of an SSE2 register
+const int kGroupWidth = 16;
+
+/** @brief Gets the fingerprint of a hash kept in the control byte of its slot:
+ *         its 7 highest bits, as the disperse functions mostly use the lowest ones.
+ */
+inline unsigned char Fingerprint(HashValue hash) { return (unsigned char)(hash >> 57); }
+
+inline bool HoldsKey(unsigned char control) { return (control & 0x80) == 0; }
+
+/** @brief Gets the mask of the first bytes of a group that belong to a block
+ *  @param[in] slots. The number of slots of the block from the first byte of the group.
+ */
+inline unsigned GroupMask(int slots) { return slots >= kGroupWidth ? (1u << kGroupWidth) - 1 : (1u << slots) - 1; }
+
+/** @brief Compares a group of kGroupWidth control bytes with one at once
+ *  @param[in] group. The first byte of the group.
+ *  @param[in] control. The control byte searched.
+ *  @return A mask with the bit i set if the byte i of the group is the one searched.
+ */
+inline unsigned MatchControl(const unsigned char* group, unsigned char control) {
+#ifdef __SSE2__
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(char(control)))));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < kGroupWidth; ++i) mask |= unsigned(group[i] == control) << i;
+  return mask;
+#endif
+}
+
+/** @brief Finds the slots of a group of kGroupWidth control bytes without a key at once
+ *  @param[in] group. The first byte of the group.
+ *  @return A mask with the bit i set if the slot of the byte i of the group is empty or deleted.
+ */
+inline unsigned MatchFree(const unsigned char* group) {
+#ifdef __SSE2__
+  return unsigned(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < kGroupWidth; ++i) mask |= unsigned(!HoldsKey(group[i])) << i;
+  return mask;
+#endif
+}
+
 template <class Key>
 class Sequence {
  public:
@@ -18,11 +82,17 @@ class DynamicSequence: public Sequence<Key> {
  public:
   DynamicSequence() {}
   virtual ~DynamicSequence();
-  bool Search(const Key& key) const;
+  bool Search(const Key& key) const { return Find(key) != nullptr; }
   bool Insert(const Key& key);
-  bool Delete(const Key& key);
+  bool Insert(Key&& key);
+  bool Delete(const Key& key) { return Erase(key); }
+  template<class K> Key* Find(const K& key) const;
+  template<class K> bool Erase(const K& key);
   Key GetKey(const int& index) const { return *block_[index]; }
   int GetSize() const { return block_.size(); }
+  void Prefetch() const { if (!block_.empty()) PrefetchLine(block_.data()); }
+  void PrefetchKeys() const { for (const Key* key : block_) PrefetchLine(key); }
+  template<class Visitor> void ForEach(Visitor&& visit) const { for (const Key* key : block_) visit(*key); }
   std::ostream& Write(std::ostream& out) const;
  private:
   std::vector<Key*> block_;
@@ -33,10 +103,19 @@ class StaticSequence: public Sequence<Key> {
  public:
   StaticSequence(const int& block_size);
   virtual ~StaticSequence();
-  bool Search(const Key& key) const;
+  bool Search(const Key& key) const { return Find(key) != nullptr; }
   bool Insert(const Key& key);
-  bool Delete(const Key& key);
-  virtual bool IsFull() const;
+  bool Insert(Key&& key);
+  bool Delete(const Key& key) { return Erase(key); }
+  template<class K> Key* Find(const K& key) const;
+  template<class K> bool Erase(const K& key);
+  virtual bool IsFull() const { return top_ == block_size_; }
+  bool HasEmpty() const { return used_ < block_size_; }
+  void Prefetch() const { PrefetchLine(block_); }
+  void PrefetchKeys() const { for (int i = 0; i < top_; ++i) PrefetchLine(block_[i]); }
+  bool IsOccupied(const int& index) const { return index < top_; }
+  Key& At(const int& index) { return *block_[index]; }
+  template<class Visitor> void ForEach(Visitor&& visit) const { for (int i = 0; i < top_; ++i) visit(*block_[i]); }
   Key GetKey(const int& index) const {
     if (block_[index] == nullptr) return Book();
     return *block_[index]; 
@@ -44,10 +123,109 @@ class StaticSequence: public Sequence<Key> {
   std::ostream& Write(std::ostream& out) const;
  private:
   int block_size_;
+  // The keys are kept in [0, top_); used_ is the most slots ever occupied, so
+  // the slots in [top_, used_) are tombstones that keep the probe chains going
   int top_ = 0;
+  int used_ = 0;
   Key** block_;
 };
 
+/** Closed hashing container that keeps every slot of every block of the table in a
+ *  single cache-line aligned allocation. The metadata bytes of all the slots are
+ *  stored first, followed by the keys themselves, so a probe step only touches
+ *  the metadata of one block and the keys it has to compare. The metadata byte
+ *  of a slot is a control byte with the fingerprint of its key, and the ones of
+ *  a block are compared kGroupWidth at a time, so only the keys whose
+ *  fingerprint matches the one searched are compared.
+ */
+template<class Key>
+class FlatSequence {
+ public:
+  FlatSequence(const unsigned& table_size, const int& block_size);
+  ~FlatSequence();
+  FlatSequence(const FlatSequence&) = delete;
+  FlatSequence& operator=(const FlatSequence&) = delete;
+  template<class K> bool Search(const unsigned& block, const K& key) const { return Find(block, key) != nullptr; }
+  template<class K> Key* Find(const unsigned& block, const K& key) const;
+  bool Insert(const unsigned& block, const Key& key);
+  bool Insert(const unsigned& block, Key&& key);
+  template<class K> bool Delete(const unsigned& block, const K& key);
+  bool IsFull(const unsigned& block) const;
+  bool HasEmpty(const unsigned& block) const;
+  // Number of dependent loads that reach the keys of a block, prefetched one after the other by the batches
+  static constexpr int kPrefetchSteps = 1;
+  void Prefetch(const unsigned& block, int /*step*/ = 0) const { PrefetchLine(Metadata(block)); PrefetchLine(Slots(block)); }
+  template<class Visitor> void ForEach(Visitor&& visit) const;
+  template<class Visitor> void ForEachInBlock(const unsigned& block, Visitor&& visit) const;
+  bool IsOccupied(const unsigned& block, const int& index) const { return HoldsKey(Metadata(block)[index]); }
+  void Construct(const unsigned& block, const int& index, Key&& key);
+  template<class K> void Replace(const unsigned& block, const int& index, K&& key);
+  void Destroy(const unsigned& block, const int& index);
+  Key& At(const unsigned& block, const int& index) { return Slots(block)[index]; }
+  const Key& At(const unsigned& block, const int& index) const { return Slots(block)[index]; }
+  Key GetKey(const unsigned& block, const int& index) const;
+  template<class K, class Accept> int FindSlot(const unsigned& block, const K& key, const Accept& accept) const;
+  unsigned GetTableSize() const { return table_size_; }
+  void Swap(FlatSequence& other);
+ private:
+  const unsigned char* Metadata(const unsigned& block) const { return metadata_ + size_t(block) * block_size_; }
+  unsigned char* Metadata(const unsigned& block) { return metadata_ + size_t(block) * block_size_; }
+  Key* Slots(const unsigned& block) const { return slots_ + size_t(block) * block_size_; }
+  int FreeSlot(const unsigned& block) const;
+  template<class K> int FindSlot(const unsigned& block, const K& key) const { return FindSlot(block, key, [](int) { return true; }); }
+  unsigned table_size_;
+  int block_size_;
+  unsigned char* storage_ = nullptr;
+  unsigned char* metadata_ = nullptr;
+  Key* slots_ = nullptr;
+};
+
+/** Blocks of a table kept in a container of their own each, StaticSequence or
+ *  DynamicSequence, with the interface of a FlatSequence so the table reaches
+ *  the keys of a block the same way whatever it keeps them in.
+ */
+template<class Key, class Container>
+class SequenceBlocks {
+ public:
+  SequenceBlocks(const unsigned& table_size, const int& block_size);
+  ~SequenceBlocks();
+  SequenceBlocks(const SequenceBlocks&) = delete;
+  SequenceBlocks& operator=(const SequenceBlocks&) = delete;
+  template<class K> Key* Find(const unsigned& block, const K& key) const { return blocks_[block]->Find(key); }
+  template<class K> bool Insert(const unsigned& block, K&& key) { return blocks_[block]->Insert(std::forward<K>(key)); }
+  template<class K> bool Delete(const unsigned& block, const K& key) { return blocks_[block]->Erase(key); }
+  bool IsFull(const unsigned& block) const { return blocks_[block]->IsFull(); }
+  bool HasEmpty(const unsigned& block) const { return blocks_[block]->HasEmpty(); }
+  // The pointer to the container of a block, its header, its slots and its keys
+  static constexpr int kPrefetchSteps = 4;
+  void Prefetch(const unsigned& block, int step) const;
+  template<class Visitor> void ForEachInBlock(const unsigned& block, Visitor&& visit) const { blocks_[block]->ForEach(visit); }
+  bool IsOccupied(const unsigned& block, const int& index) const { return blocks_[block]->IsOccupied(index); }
+  Key& At(const unsigned& block, const int& index) { return blocks_[block]->At(index); }
+  unsigned GetTableSize() const { return table_size_; }
+  void Swap(SequenceBlocks& other);
+ private:
+  unsigned table_size_;
+  Container** blocks_;
+};
+
+// Blocks of a closed table: a FlatSequence keeps them itself, the other containers hold one block each
+template<class Key, class Container>
+struct BlockStorage { typedef SequenceBlocks<Key, Container> Type; };
+
+template<class Key>
+struct BlockStorage<Key, FlatSequence<Key>> { typedef FlatSequence<Key> Type; };
+
+/** Buckets of a cuckoo table. They are stored as the blocks of a FlatSequence,
+ *  this type only tells the HashTable to keep every key in one of its two
+ *  candidate blocks instead of following a probe sequence.
+ */
+template<class Key>
+class CuckooSequence : public FlatSequence<Key> {
+ public:
+  CuckooSequence(const unsigned& table_size, const int& block_size) : FlatSequence<Key>(table_size, block_size) {}
+};
+
 // ================================ DYNAMIC SEQUENCE ================================ //
 
 /** @brief Destructor of the DynamicSequence class */
@@ -59,15 +237,16 @@ DynamicSequence<Key>::~DynamicSequence() {
 }
 
 /** @brief Searchs a key in the sequence
- *  @param[in] key. The key to search.
- *  @return True if the key is in the sequence, false otherwise.
+ *  @param[in] key. The key to search, or a view of it.
+ *  @return A pointer to the stored key, nullptr if it is not in the sequence.
  */
 template<class Key>
-bool DynamicSequence<Key>::Search(const Key& key) const {
+template<class K>
+Key* DynamicSequence<Key>::Find(const K& key) const {
   for (unsigned i = 0; i < block_.size(); ++i) {
-    if (*block_[i] == key) return true;
+    if (*block_[i] == key) return block_[i];
   }
-  return false;
+  return nullptr;
 }
 
 /** @brief Inserts a key in the sequence
@@ -80,10 +259,22 @@ bool DynamicSequence<Key>::Insert(const Key& key) {
   return true;
 }
 
+template<class Key>
+bool DynamicSequence<Key>::Insert(Key&& key) {
+  block_.push_back(new Key(std::move(key)));
+  return true;
+}
+
+/** @brief Deletes a key from the sequence
+ *  @param[in] key. The key to delete, or a view of it.
+ *  @return True if the key has been deleted, false otherwise.
+ */
 template <class Key>
-bool DynamicSequence<Key>::Delete(const Key& key) {
+template <class K>
+bool DynamicSequence<Key>::Erase(const K& key) {
   for (unsigned i = 0; i < block_.size(); ++i) {
     if (*block_[i] == key) {
+      delete block_[i];
       block_.erase(block_.begin() + i);
       return true;
     }
@@ -130,15 +321,16 @@ StaticSequence<Key>::~StaticSequence() {
 }
 
 /** @brief Searchs a key in the sequence
- *  @param[in] key. The key to search.
- *  @return True if the key is in the sequence, false otherwise.
+ *  @param[in] key. The key to search, or a view of it.
+ *  @return A pointer to the stored key, nullptr if it is not in the sequence.
  */
 template<class Key>
-bool StaticSequence<Key>::Search(const Key& key) const {
-  for (int i = 0; i < block_size_; ++i) {
-    if (block_[i] != nullptr && long(*block_[i]) == long(key)) return true;
+template<class K>
+Key* StaticSequence<Key>::Find(const K& key) const {
+  for (int i = 0; i < top_; ++i) {
+    if (*block_[i] == key) return block_[i];
   }
-  return false;
+  return nullptr;
 }
 
 /** @brief Inserts a key in the sequence
@@ -152,32 +344,46 @@ bool StaticSequence<Key>::Insert(const Key& key) {
   }
   block_[top_] = new Key(key);
   ++top_;
+  used_ = std::max(used_, top_);
   return true;
 }
 
+/** @brief Moves a key into the sequence
+ *  @param[in] key. The key to move, which is left untouched if the sequence is full.
+ *  @return True if the key has been inserted, false otherwise.
+ */
+template<class Key>
+bool StaticSequence<Key>::Insert(Key&& key) {
+  if (IsFull()) {
+    return false;
+  }
+  block_[top_] = new Key(std::move(key));
+  ++top_;
+  used_ = std::max(used_, top_);
+  return true;
+}
+
+/** @brief Deletes a key from the sequence. The last key of the sequence is
+ *         moved to the freed slot, so the occupied slots stay contiguous and
+ *         the next insertion reuses it.
+ *  @param[in] key. The key to delete, or a view of it.
+ *  @return True if the key has been deleted, false otherwise.
+ */
 template <class Key>
-bool StaticSequence<Key>::Delete(const Key& key) {
-  for (int i = 0; i < block_size_; ++i) {
-    if (block_[i] != nullptr && long(*block_[i]) == long(key)) {
+template <class K>
+bool StaticSequence<Key>::Erase(const K& key) {
+  for (int i = 0; i < top_; ++i) {
+    if (*block_[i] == key) {
       delete block_[i];
-      block_[i] = nullptr;
+      --top_;
+      block_[i] = block_[top_];
+      block_[top_] = nullptr;
       return true;
     }
   }
   return false;
 }
 
-/** @brief Checks if the sequence is full
- *  @return True if the sequence is full, false otherwise.
- */
-template<class Key>
-bool StaticSequence<Key>::IsFull() const { 
-  for (int i = 0; i < block_size_; ++i) {
-    if (block_[i] == nullptr) return false;
-  }
-  return true;
-}
-
 /** @brief Writes the key in the sequence
  *  @param[in] out. The output stream.
  *  @param[in] index. The index of the key.
@@ -185,12 +391,291 @@ bool StaticSequence<Key>::IsFull() const {
  */
 template <class Key>
 std::ostream& StaticSequence<Key>::Write(std::ostream& out) const {
-  for (int i = 0; i < block_size_; ++i) {
-    if (block_[i] != nullptr) {
-      out << std::string(*block_[i]) << " | ";
-    }
+  for (int i = 0; i < top_; ++i) {
+    out << std::string(*block_[i]) << " | ";
   }
   return out;
 }
 
+// ================================ FLAT SEQUENCE ================================ //
+
+/** @brief Constructor of the FlatSequence class. Allocates the metadata and the
+ *         slots of the whole table in one cache-line aligned block of memory.
+ *  @param[in] table_size. The number of blocks.
+ *  @param[in] block_size. The number of slots of each block.
+ */
+template<class Key>
+FlatSequence<Key>::FlatSequence(const unsigned& table_size, const int& block_size) {
+  table_size_ = table_size;
+  block_size_ = block_size;
+  size_t slot_count = size_t(table_size) * block_size;
+  // The keys start at the first cache line after the metadata, which has room
+  // for the group of the last block to be read whole
+  size_t metadata_bytes = (slot_count + kGroupWidth + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+  storage_ = static_cast<unsigned char*>(::operator new(metadata_bytes + slot_count * sizeof(Key), std::align_val_t(kCacheLineSize)));
+  metadata_ = storage_;
+  slots_ = reinterpret_cast<Key*>(storage_ + metadata_bytes);
+  std::memset(metadata_, kEmpty, metadata_bytes);
+}
+
+/** @brief Destructor of the FlatSequence class */
+template<class Key>
+FlatSequence<Key>::~FlatSequence() {
+  size_t slot_count = size_t(table_size_) * block_size_;
+  for (size_t i = 0; i < slot_count; ++i) {
+    if (HoldsKey(metadata_[i])) slots_[i].~Key();
+  }
+  ::operator delete(storage_, std::align_val_t(kCacheLineSize));
+}
+
+/** @brief Searchs a key in a block
+ *  @param[in] block. The block where the key is searched.
+ *  @param[in] key. The key to search, or a view of it.
+ *  @return A pointer to the stored key, nullptr if it is not in the block.
+ */
+template<class Key>
+template<class K>
+Key* FlatSequence<Key>::Find(const unsigned& block, const K& key) const {
+  int slot = FindSlot(block, key);
+  return slot < 0 ? nullptr : Slots(block) + slot;
+}
+
+/** @brief Gets the slot of a block that holds a key. Every group of control
+ *         bytes of the block is compared with the fingerprint of the key at
+ *         once, and only the keys of the slots that match are compared.
+ *  @param[in] block. The block where the key is searched.
+ *  @param[in] key. The key to search, or a view of it.
+ *  @param[in] accept. Tells by its index if a slot whose fingerprint matches can hold the key.
+ *  @return The index of the slot in the block, or -1 if the key is not in the block.
+ */
+template<class Key>
+template<class K, class Accept>
+int FlatSequence<Key>::FindSlot(const unsigned& block, const K& key, const Accept& accept) const {
+  const unsigned char* metadata = Metadata(block);
+  const Key* slots = Slots(block);
+  unsigned char fingerprint = Fingerprint(HashValue(key));
+  for (int group = 0; group < block_size_; group += kGroupWidth) {
+    unsigned match = MatchControl(metadata + group, fingerprint) & GroupMask(block_size_ - group);
+    for (; match != 0; match &= match - 1) {
+      int slot = group + __builtin_ctz(match);
+      if (accept(slot) && slots[slot] == key) return slot;
+    }
+  }
+  return -1;
+}
+
+/** @brief Gets the first slot of a block that is not occupied
+ *  @param[in] block. The block to check.
+ *  @return The index of the slot in the block, or -1 if the block is full.
+ */
+template<class Key>
+int FlatSequence<Key>::FreeSlot(const unsigned& block) const {
+  const unsigned char* metadata = Metadata(block);
+  for (int group = 0; group < block_size_; group += kGroupWidth) {
+    unsigned free = MatchFree(metadata + group) & GroupMask(block_size_ - group);
+    if (free != 0) return group + __builtin_ctz(free);
+  }
+  return -1;
+}
+
+/** @brief Inserts a key in the first free slot of a block
+ *  @param[in] block. The block where the key is inserted.
+ *  @param[in] key. The key to insert.
+ *  @return True if the key has been inserted, false if the block is full.
+ */
+template<class Key>
+bool FlatSequence<Key>::Insert(const unsigned& block, const Key& key) {
+  int slot = FreeSlot(block);
+  if (slot < 0) return false;
+  new (Slots(block) + slot) Key(key);
+  Metadata(block)[slot] = Fingerprint(HashValue(key));
+  return true;
+}
+
+/** @brief Moves a key into the first free slot of a block
+ *  @param[in] block. The block where the key is inserted.
+ *  @param[in] key. The key to move.
+ *  @return True if the key has been inserted, false if the block is full.
+ */
+template<class Key>
+bool FlatSequence<Key>::Insert(const unsigned& block, Key&& key) {
+  int slot = FreeSlot(block);
+  if (slot < 0) return false;
+  Metadata(block)[slot] = Fingerprint(HashValue(key));
+  new (Slots(block) + slot) Key(std::move(key));
+  return true;
+}
+
+/** @brief Deletes a key from a block. The slot is marked as deleted so the
+ *         probe chains that go through this block are not cut.
+ *  @param[in] block. The block where the key is.
+ *  @param[in] key. The key to delete, or a view of it.
+ *  @return True if the key has been deleted, false otherwise.
+ */
+template<class Key>
+template<class K>
+bool FlatSequence<Key>::Delete(const unsigned& block, const K& key) {
+  int slot = FindSlot(block, key);
+  if (slot < 0) return false;
+  Slots(block)[slot].~Key();
+  Metadata(block)[slot] = kDeleted;
+  return true;
+}
+
+/** @brief Moves a key into a slot that is not occupied
+ *  @param[in] block. The block of the slot.
+ *  @param[in] index. The index of the slot in the block.
+ *  @param[in] key. The key to move.
+ */
+template<class Key>
+void FlatSequence<Key>::Construct(const unsigned& block, const int& index, Key&& key) {
+  Metadata(block)[index] = Fingerprint(HashValue(key));
+  new (Slots(block) + index) Key(std::move(key));
+}
+
+/** @brief Assigns a key to an occupied slot, updating its fingerprint
+ *  @param[in] block. The block of the slot.
+ *  @param[in] index. The index of the slot in the block.
+ *  @param[in] key. The key to assign, moved if it is an rvalue.
+ */
+template<class Key>
+template<class K>
+void FlatSequence<Key>::Replace(const unsigned& block, const int& index, K&& key) {
+  Metadata(block)[index] = Fingerprint(HashValue(key));
+  Slots(block)[index] = std::forward<K>(key);
+}
+
+/** @brief Destroys the key of an occupied slot, which is left empty, not
+ *         deleted, for the tables that don't need tombstones.
+ *  @param[in] block. The block of the slot.
+ *  @param[in] index. The index of the slot in the block.
+ */
+template<class Key>
+void FlatSequence<Key>::Destroy(const unsigned& block, const int& index) {
+  Slots(block)[index].~Key();
+  Metadata(block)[index] = kEmpty;
+}
+
+/** @brief Checks if a block is full
+ *  @param[in] block. The block to check.
+ *  @return True if every slot of the block is occupied, false otherwise.
+ */
+template<class Key>
+bool FlatSequence<Key>::IsFull(const unsigned& block) const {
+  return FreeSlot(block) < 0;
+}
+
+/** @brief Checks if a block has a slot that has never been used. A probe
+ *         sequence can stop at such a block, as no key was moved past it.
+ *  @param[in] block. The block to check.
+ *  @return True if the block has an empty slot, false otherwise.
+ */
+template<class Key>
+bool FlatSequence<Key>::HasEmpty(const unsigned& block) const {
+  const unsigned char* metadata = Metadata(block);
+  for (int group = 0; group < block_size_; group += kGroupWidth) {
+    if ((MatchControl(metadata + group, kEmpty) & GroupMask(block_size_ - group)) != 0) return true;
+  }
+  return false;
+}
+
+/** @brief Gets a copy of the key stored in a slot
+ *  @param[in] block. The block of the slot.
+ *  @param[in] index. The index of the slot in the block.
+ *  @return The key, or a default one if the slot is not occupied.
+ */
+template<class Key>
+Key FlatSequence<Key>::GetKey(const unsigned& block, const int& index) const {
+  if (!HoldsKey(Metadata(block)[index])) return Key();
+  return Slots(block)[index];
+}
+
+/** @brief Visits every key of the container, block by block
+ *  @param[in] visit. The function called with every key.
+ */
+template<class Key>
+template<class Visitor>
+void FlatSequence<Key>::ForEach(Visitor&& visit) const {
+  size_t slot_count = size_t(table_size_) * block_size_;
+  for (size_t i = 0; i < slot_count; ++i) {
+    if (HoldsKey(metadata_[i])) visit(slots_[i]);
+  }
+}
+
+/** @brief Visits the keys of a block, in the order of its slots
+ *  @param[in] block. The block to visit.
+ *  @param[in] visit. The function called with every key.
+ */
+template<class Key>
+template<class Visitor>
+void FlatSequence<Key>::ForEachInBlock(const unsigned& block, Visitor&& visit) const {
+  const unsigned char* metadata = Metadata(block);
+  const Key* slots = Slots(block);
+  for (int i = 0; i < block_size_; ++i) {
+    if (HoldsKey(metadata[i])) visit(slots[i]);
+  }
+}
+
+/** @brief Exchanges the slots of two containers
+ *  @param[in] other. The container to exchange the slots with.
+ */
+template<class Key>
+void FlatSequence<Key>::Swap(FlatSequence& other) {
+  std::swap(table_size_, other.table_size_);
+  std::swap(block_size_, other.block_size_);
+  std::swap(storage_, other.storage_);
+  std::swap(metadata_, other.metadata_);
+  std::swap(slots_, other.slots_);
+}
+
+// ================================ SEQUENCE BLOCKS ================================ //
+
+/** @brief Constructor of the SequenceBlocks class
+ *  @param[in] table_size. The number of blocks.
+ *  @param[in] block_size. The number of slots of each block, which a DynamicSequence doesn't have.
+ */
+template<class Key, class Container>
+SequenceBlocks<Key, Container>::SequenceBlocks(const unsigned& table_size, const int& block_size) {
+  table_size_ = table_size;
+  blocks_ = new Container*[table_size];
+  for (unsigned i = 0; i < table_size; ++i) {
+    if constexpr (std::is_constructible<Container, int>::value) blocks_[i] = new Container(block_size);
+    else blocks_[i] = new Container();
+  }
+}
+
+/** @brief Destructor of the SequenceBlocks class */
+template<class Key, class Container>
+SequenceBlocks<Key, Container>::~SequenceBlocks() {
+  for (unsigned i = 0; i < table_size_; ++i) {
+    delete blocks_[i];
+  }
+  delete[] blocks_;
+}
+
+/** @brief Prefetches one level of the memory a search of a block reads. Every
+ *         step reads what the previous one has prefetched, so the steps of a
+ *         block are taken one after the other, with other work in between.
+ *  @param[in] block. The block.
+ *  @param[in] step. The level, from 0 to kPrefetchSteps - 1.
+ */
+template<class Key, class Container>
+void SequenceBlocks<Key, Container>::Prefetch(const unsigned& block, int step) const {
+  switch (step) {
+    case 0:  PrefetchLine(blocks_ + block); break;
+    case 1:  PrefetchLine(blocks_[block]); break;
+    case 2:  blocks_[block]->Prefetch(); break;
+    default: blocks_[block]->PrefetchKeys(); break;
+  }
+}
+
+/** @brief Exchanges the blocks of two containers
+ *  @param[in] other. The container to exchange the blocks with.
+ */
+template<class Key, class Container>
+void SequenceBlocks<Key, Container>::Swap(SequenceBlocks& other) {
+  std::swap(table_size_, other.table_size_);
+  std::swap(blocks_, other.blocks_);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+// Vector that keeps its first N elements inside the object and only allocates
+// memory when it holds more. The elements are copied as bytes, so they must be
+// trivially copyable.
+template<class T, unsigned N>
+class SmallVector {
+  static_assert(std::is_trivially_copyable<T>::value, "SmallVector copies its elements as bytes");
+ public:
+  SmallVector() {}
+  SmallVector(const SmallVector& other) { CopyFrom(other); }
+  SmallVector(SmallVector&& other) noexcept { MoveFrom(other); }
+  ~SmallVector() { Release(); }
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      size_ = 0;
+      CopyFrom(other);
+    }
+    return *this;
+  }
+  SmallVector& operator=(SmallVector&& other) noexcept {
+    if (this != &other) {
+      Release();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+  void push_back(const T& value) {
+    if (size_ == capacity_) Grow(2 * capacity_);
+    new (data_ + size_) T(value);
+    ++size_;
+  }
+  void clear() { size_ = 0; }
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  const T* data() const { return data_; }
+  const T* begin() const { return data_; }
+  const T* end() const { return data_ + size_; }
+  T* begin() { return data_; }
+  T* end() { return data_ + size_; }
+  const T& operator[](size_t index) const { return data_[index]; }
+  T& operator[](size_t index) { return data_[index]; }
+  const T& back() const { return data_[size_ - 1]; }
+ private:
+  bool IsInline() const { return data_ == reinterpret_cast<const T*>(inline_); }
+  void Grow(uint32_t capacity);
+  void CopyFrom(const SmallVector& other);
+  void MoveFrom(SmallVector& other);
+  void Release();
+  T* data_ = reinterpret_cast<T*>(inline_);
+  uint32_t size_ = 0;
+  uint32_t capacity_ = N;
+  alignas(T) unsigned char inline_[N * sizeof(T)];
+};
+
+/** @brief Moves the elements to a bigger block of memory
+ *  @param[in] capacity. The number of elements of the new block.
+ */
+template<class T, unsigned N>
+void SmallVector<T, N>::Grow(uint32_t capacity) {
+  T* data = static_cast<T*>(std::malloc(size_t(capacity) * sizeof(T)));
+  if (data == nullptr) throw std::bad_alloc();
+  std::memcpy(static_cast<void*>(data), data_, size_t(size_) * sizeof(T));
+  Release();
+  data_ = data;
+  capacity_ = capacity;
+}
+
+/** @brief Copies the elements of another vector into an empty one */
+template<class T, unsigned N>
+void SmallVector<T, N>::CopyFrom(const SmallVector& other) {
+  if (other.size_ > capacity_) Grow(other.size_);
+  std::memcpy(static_cast<void*>(data_), other.data_, size_t(other.size_) * sizeof(T));
+  size_ = other.size_;
+}
+
+/** @brief Takes the elements of another vector, which is left empty. The
+ *         memory of a vector that allocates is taken instead of copied.
+ */
+template<class T, unsigned N>
+void SmallVector<T, N>::MoveFrom(SmallVector& other) {
+  if (other.IsInline()) {
+    data_ = reinterpret_cast<T*>(inline_);
+    capacity_ = N;
+    std::memcpy(static_cast<void*>(data_), other.data_, size_t(other.size_) * sizeof(T));
+  }
+  else {
+    data_ = other.data_;
+    capacity_ = other.capacity_;
+    other.data_ = reinterpret_cast<T*>(other.inline_);
+    other.capacity_ = N;
+  }
+  size_ = other.size_;
+  other.size_ = 0;
+}
+
+/** @brief Frees the memory allocated by the vector, if any */
+template<class T, unsigned N>
+void SmallVector<T, N>::Release() {
+  if (!IsInline()) std::free(data_);
+  data_ = reinterpret_cast<T*>(inline_);
+  capacity_ = N;
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary snapshot of a table of books. It is a memory image of the books, so
+// it is loaded by mapping the file and reading the records in place:
+//
+//   SnapshotHeader | SnapshotBook[book_count] | SnapshotReservation[reservation_count] | strings
+//
+// The strings of every record are slices of the string section and the dates
+// are their numbers of days (see date.h). The integers are stored in the byte order of the machine
+// that wrote the snapshot.
+
+const char kSnapshotMagic[8] = {'L', 'I', 'B', 'S', 'N', 'A', 'P', '\0'};
+// Incremented every time the layout of the records changes
+const uint32_t kSnapshotVersion = 2;
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  // The hashes of the books can be reused if the table has the same search mode and seed
+  uint32_t search_mode;
+  uint64_t hash_seed;
+  uint64_t book_count;
+  uint64_t reservation_count;
+  uint64_t string_bytes;
+};
+
+struct SnapshotString {
+  uint64_t offset;
+  uint64_t length;
+};
+
+struct SnapshotBook {
+  uint64_t hash;
+  double price;
+  SnapshotString name;
+  SnapshotString author;
+  uint64_t first_reservation;
+  uint64_t reservation_count;
+};
+
+struct SnapshotReservation {
+  SnapshotString name;
+  int32_t start_day;
+  int32_t return_day;
+};
+
+/** Read only memory mapping of a whole file, unmapped when it is destroyed. */
+class MappedFile {
+ public:
+  MappedFile(const std::string& path) {
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) return;
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+      void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const char*>(data);
+        size_ = status.st_size;
+        madvise(data, size_, MADV_SEQUENTIAL);
+      }
+    }
+    close(descriptor);
+  }
+  ~MappedFile() { if (data_ != nullptr) munmap(const_cast<char*>(data_), size_); }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  bool IsOpen() const { return data_ != nullptr; }
+  const char* GetData() const { return data_; }
+  size_t GetSize() const { return size_; }
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+/** @brief Writes all the bytes of a text to a file, as write() may write only a part of them
+ *  @param[in] descriptor. The file.
+ *  @param[in] data. The text.
+ *  @return True if the whole text has been written, false otherwise.
+ */
+inline bool WriteAll(int descriptor, std::string_view data) {
+  while (!data.empty()) {
+    ssize_t written = write(descriptor, data.data(), data.size());
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    data.remove_prefix(written);
+  }
+  return true;
+}
+
+/** @brief Replaces the contents of a file at once. They are written to a
+ *         temporary file next to it, which is synced and renamed over it, so
+ *         the file has either the old or the new contents even after a crash.
+ *  @param[in] path. The path of the file.
+ *  @param[in] contents. The new contents.
+ *  @return True if the file has the new contents, false otherwise.
+ */
+inline bool PublishFile(const std::string& path, std::string_view contents) {
+  std::string temporary = path + ".tmp";
+  int descriptor = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (descriptor < 0) return false;
+  bool written = WriteAll(descriptor, contents) && fsync(descriptor) == 0;
+  written = close(descriptor) == 0 && written;
+  if (!written || rename(temporary.c_str(), path.c_str()) != 0) {
+    unlink(temporary.c_str());
+    return false;
+  }
+  // The rename is on the disk once the directory is synced
+  size_t slash = path.rfind('/');
+  std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+  int directory_descriptor = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if (directory_descriptor >= 0) {
+    fsync(directory_descriptor);
+    close(directory_descriptor);
+  }
+  return true;
+}
+
+/** @brief Appends a string to the string section of a snapshot being written
+ *  @param[in] pool. The string section.
+ *  @param[in] text. The string to append.
+ *  @return The slice of the section that holds the string.
+ */
+inline SnapshotString AddSnapshotString(std::string& pool, std::string_view text) {
+  SnapshotString slice = {pool.size(), text.size()};
+  pool.append(text);
+  return slice;
+}
+
+/** @brief Checks that a slice is inside the string section of a snapshot
+ *  @param[in] slice. The slice to check.
+ *  @param[in] string_bytes. The size of the string section.
+ *  @return True if the slice is valid, false otherwise.
+ */
+inline bool IsValidSnapshotString(const SnapshotString& slice, uint64_t string_bytes) {
+  return slice.offset <= string_bytes && slice.length <= string_bytes - slice.offset;
+}
+
+#endif
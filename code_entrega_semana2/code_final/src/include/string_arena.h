@@ -0,0 +1,133 @@
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Storage of the strings of the keys of a table. The strings are packed one
+// after another in big blocks that never move, so the keys reference them
+// instead of owning them, and destroying the table frees a few blocks instead
+// of every string. The strings of the deleted keys stay in the blocks until the
+// arena is destroyed.
+
+// Number of bytes of every block of an arena
+const size_t kArenaBlockSize = 64 * 1024;
+
+class StringArena {
+ public:
+  StringArena() {}
+  StringArena(const StringArena&) = delete;
+  StringArena& operator=(const StringArena&) = delete;
+  std::string_view Store(std::string_view text);
+  std::string_view Intern(std::string_view text);
+  // Number of bytes of the strings stored
+  size_t GetBytes() const { return bytes_; }
+ private:
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* next_ = nullptr;
+  size_t available_ = 0;
+  size_t bytes_ = 0;
+  // The strings stored by Intern(), which views them in the blocks
+  std::unordered_set<std::string_view> interned_;
+};
+
+/** @brief Copies a string to the arena
+ *  @param[in] text. The string.
+ *  @return The copy of the string, which lives as long as the arena.
+ */
+inline std::string_view StringArena::Store(std::string_view text) {
+  if (text.empty()) return std::string_view();
+  char* stored;
+  if (text.size() > kArenaBlockSize / 4) {
+    // A long string gets a block of its own, so the free space of the current block is not lost
+    blocks_.emplace_back(new char[text.size()]);
+    stored = blocks_.back().get();
+  }
+  else {
+    if (text.size() > available_) {
+      blocks_.emplace_back(new char[kArenaBlockSize]);
+      next_ = blocks_.back().get();
+      available_ = kArenaBlockSize;
+    }
+    stored = next_;
+    next_ += text.size();
+    available_ -= text.size();
+  }
+  std::memcpy(stored, text.data(), text.size());
+  bytes_ += text.size();
+  return std::string_view(stored, text.size());
+}
+
+/** @brief Copies a string to the arena once. Storing again an equal string
+ *         returns the first copy.
+ *  @param[in] text. The string.
+ *  @return The copy of the string, which lives as long as the arena.
+ */
+inline std::string_view StringArena::Intern(std::string_view text) {
+  auto found = interned_.find(text);
+  if (found != interned_.end()) return *found;
+  std::string_view stored = Store(text);
+  interned_.insert(stored);
+  return stored;
+}
+
+// Name and author of a book. They are either a copy owned by the book or a
+// reference to the arena of the table that holds it, which is copied as is.
+class BookStrings {
+ public:
+  BookStrings() {}
+  BookStrings(std::string_view name, std::string_view author);
+  BookStrings(const BookStrings& strings);
+  BookStrings(const BookStrings& strings, StringArena& arena) { Reference(arena.Store(strings.Name()), arena.Intern(strings.Author())); }
+  BookStrings(BookStrings&& strings) noexcept = default;
+  BookStrings& operator=(const BookStrings& strings) { return *this = BookStrings(strings); }
+  BookStrings& operator=(BookStrings&& strings) noexcept = default;
+  std::string_view Name() const { return std::string_view(name_, name_length_); }
+  std::string_view Author() const { return std::string_view(author_, author_length_); }
+  // Moves the strings to an arena. The author is interned, as it is shared by every book of the author.
+  void StoreIn(StringArena& arena);
+ private:
+  void Reference(std::string_view name, std::string_view author);
+  const char* name_ = nullptr;
+  const char* author_ = nullptr;
+  uint32_t name_length_ = 0;
+  uint32_t author_length_ = 0;
+  // The name followed by the author, if they are not in an arena
+  std::unique_ptr<char[]> storage_;
+};
+
+/** @brief Copies a name and an author into a single block owned by the strings
+ *  @param[in] name. The name.
+ *  @param[in] author. The author.
+ */
+inline BookStrings::BookStrings(std::string_view name, std::string_view author) {
+  if (!name.empty() || !author.empty()) {
+    storage_.reset(new char[name.size() + author.size()]);
+    std::memcpy(storage_.get(), name.data(), name.size());
+    std::memcpy(storage_.get() + name.size(), author.data(), author.size());
+  }
+  Reference(std::string_view(storage_.get(), name.size()), std::string_view(storage_.get() + name.size(), author.size()));
+}
+
+inline BookStrings::BookStrings(const BookStrings& strings) {
+  if (strings.storage_ != nullptr) *this = BookStrings(strings.Name(), strings.Author());
+  else                             Reference(strings.Name(), strings.Author());
+}
+
+inline void BookStrings::StoreIn(StringArena& arena) {
+  Reference(arena.Store(Name()), arena.Intern(Author()));
+  storage_.reset();
+}
+
+inline void BookStrings::Reference(std::string_view name, std::string_view author) {
+  name_ = name.data();
+  author_ = author.data();
+  name_length_ = name.size();
+  author_length_ = author.size();
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef STRING_HASH_H
+#define STRING_HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// Hash number of the keys, the input of every disperse and exploration function
+typedef uint64_t HashValue;
+
+// Odd 64 bit constants with well distributed bits used by the mixing steps
+const HashValue kHashPrime0 = 0xa0761d6478bd642full;
+const HashValue kHashPrime1 = 0xe7037ed1a0b428dbull;
+const HashValue kHashPrime2 = 0x8ebc6af09c88c6e3ull;
+const HashValue kHashPrime3 = 0x589965cc75374cc3ull;
+// Seed used to hash the keys if none is specified
+const HashValue kDefaultHashSeed = 0x2d358dccaa6c78a5ull;
+
+/** @brief Multiplies two words into 128 bits and folds the halves together,
+ *         so every bit of the result depends on every bit of both inputs.
+ */
+inline HashValue HashMix(HashValue a, HashValue b) {
+  __uint128_t product = __uint128_t(a) * b;
+  return HashValue(product) ^ HashValue(product >> 64);
+}
+
+inline HashValue HashRead64(const unsigned char* bytes) {
+  HashValue value;
+  std::memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+inline HashValue HashRead32(const unsigned char* bytes) {
+  uint32_t value;
+  std::memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+/** @brief Computes the 64 bit hash of a string. The bytes are read a word at a
+ *         time, and strings longer than 48 bytes are consumed by three
+ *         independent lanes of 16 bytes each so their multiplications overlap.
+ *         SSE2 would only mix 32 bit halves per multiplication, and the names
+ *         and authors hashed are mostly shorter than a single 48 byte round.
+ *  @param[in] data. The bytes to hash.
+ *  @param[in] length. The number of bytes.
+ *  @param[in] seed. The seed of the hash.
+ *  @return The hash of the string.
+ */
+inline HashValue StringHash(const char* data, size_t length, HashValue seed = kDefaultHashSeed) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  seed ^= HashMix(seed ^ kHashPrime0, kHashPrime1);
+  HashValue a = 0, b = 0;
+  if (length <= 16) {
+    if (length >= 4) {
+      size_t middle = (length >> 3) << 2;
+      a = (HashRead32(bytes) << 32) | HashRead32(bytes + middle);
+      b = (HashRead32(bytes + length - 4) << 32) | HashRead32(bytes + length - 4 - middle);
+    }
+    else if (length > 0) {
+      a = (HashValue(bytes[0]) << 16) | (HashValue(bytes[length >> 1]) << 8) | bytes[length - 1];
+    }
+  }
+  else {
+    size_t remaining = length;
+    if (remaining > 48) {
+      HashValue lane1 = seed, lane2 = seed;
+      do {
+        seed = HashMix(HashRead64(bytes) ^ kHashPrime1, HashRead64(bytes + 8) ^ seed);
+        lane1 = HashMix(HashRead64(bytes + 16) ^ kHashPrime2, HashRead64(bytes + 24) ^ lane1);
+        lane2 = HashMix(HashRead64(bytes + 32) ^ kHashPrime3, HashRead64(bytes + 40) ^ lane2);
+        bytes += 48;
+        remaining -= 48;
+      } while (remaining > 48);
+      seed ^= lane1 ^ lane2;
+    }
+    while (remaining > 16) {
+      seed = HashMix(HashRead64(bytes) ^ kHashPrime1, HashRead64(bytes + 8) ^ seed);
+      bytes += 16;
+      remaining -= 16;
+    }
+    // The last 16 bytes of the string, which may overlap the ones already read
+    a = HashRead64(bytes + remaining - 16);
+    b = HashRead64(bytes + remaining - 8);
+  }
+  a ^= kHashPrime1;
+  b ^= seed;
+  __uint128_t product = __uint128_t(a) * b;
+  a = HashValue(product);
+  b = HashValue(product >> 64);
+  return HashMix(a ^ kHashPrime0 ^ length, b ^ kHashPrime1);
+}
+
+inline HashValue StringHash(std::string_view text, HashValue seed = kDefaultHashSeed) {
+  return StringHash(text.data(), text.size(), seed);
+}
+
+#endif
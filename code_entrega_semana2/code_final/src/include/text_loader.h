@@ -0,0 +1,152 @@
+#ifndef TEXT_LOADER_H
+#define TEXT_LOADER_H
+
+#include <charconv>
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "reservation.h"
+
+// Parser of the text database. The file is split into chunks that end at a line
+// break and every chunk is parsed by its own thread into its own vector of
+// books, viewing the fields in place instead of copying them to strings.
+// The rules are the ones of the original loader: the two header lines are
+// skipped, the fields are separated by '|' and trimmed of spaces, the price may
+// end in '€' and every reservation is written as "name @ return date".
+
+// Minimum number of bytes of the file parsed by each thread, so small files are not split
+const size_t kMinLoaderChunkSize = 1 << 20;
+// Price suffix of the database file, as it is encoded in it (UTF-8)
+const std::string_view kPriceSuffix = "\xE2\x82\xAC";
+
+/** @brief Removes the leading and trailing spaces of a field. As trim(), a field
+ *         made only of spaces is returned unchanged.
+ *  @param[in] text. The field.
+ *  @return The field without the spaces.
+ */
+inline std::string_view TrimView(std::string_view text) {
+  size_t first = text.find_first_not_of(' ');
+  if (first == std::string_view::npos) return text;
+  size_t last = text.find_last_not_of(' ');
+  return text.substr(first, last - first + 1);
+}
+
+/** @brief Takes the next field of a line, as std::getline() with a delimiter
+ *  @param[in,out] line. The rest of the line, which loses the field and its delimiter.
+ *  @param[in] delimiter. The character that ends the field.
+ *  @return The field, empty if the line has no more fields.
+ */
+inline std::string_view NextField(std::string_view& line, char delimiter) {
+  size_t end = line.find(delimiter);
+  std::string_view field = line.substr(0, end);
+  line = end == std::string_view::npos ? std::string_view() : line.substr(end + 1);
+  return field;
+}
+
+/** @brief Reads the price of a book. Only the leading number is read, as std::stod().
+ *  @param[in] text. The trimmed price field.
+ *  @param[out] price. The price read.
+ *  @return True if the field starts with a number, false otherwise.
+ */
+inline bool ParsePrice(std::string_view text, double& price) {
+  if (text.size() >= kPriceSuffix.size() && text.substr(text.size() - kPriceSuffix.size()) == kPriceSuffix) {
+    text.remove_suffix(kPriceSuffix.size());
+  }
+  while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+  return std::from_chars(text.data(), text.data() + text.size(), price).ec == std::errc();
+}
+
+/** @brief Parses a line of the database file into a book
+ *  @param[in] line. The line, without its line break.
+ *  @param[in] search_mode. The search mode of the book.
+ *  @param[out] books. The books parsed, where the book is appended.
+ *  @return True if the line is a book, false if it has no valid price.
+ */
+template<class Key>
+bool ParseRecord(std::string_view line, int search_mode, std::vector<Key>& books) {
+  std::string_view name = TrimView(NextField(line, '|'));
+  std::string_view author = TrimView(NextField(line, '|'));
+  NextField(line, '|');  // The status is deduced from the reservations
+  double price;
+  if (!ParsePrice(TrimView(NextField(line, '|')), price)) return false;
+  std::string_view reservations = TrimView(line);
+  Key& book = books.emplace_back(name, author, price, search_mode);
+  if (reservations == "-") return true;
+  while (!reservations.empty()) {
+    std::string_view reservation = TrimView(NextField(reservations, ','));
+    size_t separator = reservation.find(" @ ");
+    // Malformed reservations, and the ones whose date is not valid, are skipped
+    if (separator == std::string_view::npos) continue;
+    Date return_date;
+    if (!Date::Parse(reservation.substr(separator + 3), return_date)) continue;
+    book.AddReservation({ReaderName(reservation.substr(0, separator)), Key::GetOriginalDate(return_date), return_date});
+  }
+  return true;
+}
+
+/** @brief Parses every line of a chunk of the database file
+ *  @param[in] begin. The first byte of the chunk, the beginning of a line.
+ *  @param[in] end. The end of the chunk, after a line break or at the end of the file.
+ *  @param[in] search_mode. The search mode of the books.
+ *  @param[out] books. The books parsed.
+ */
+template<class Key>
+void ParseChunk(const char* begin, const char* end, int search_mode, std::vector<Key>& books) {
+  while (begin < end) {
+    const char* line_end = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    if (line_end == nullptr) line_end = end;
+    ParseRecord(std::string_view(begin, line_end - begin), search_mode, books);
+    begin = line_end + 1;
+  }
+}
+
+/** @brief Skips the given number of lines of a text
+ *  @return The beginning of the next line, or end if the text has no more lines.
+ */
+inline const char* SkipLines(const char* begin, const char* end, int lines) {
+  for (; lines > 0 && begin < end; --lines) {
+    const char* line_end = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    begin = line_end == nullptr ? end : line_end + 1;
+  }
+  return begin;
+}
+
+/** @brief Parses the database file in parallel. The books of every chunk are
+ *         kept in file order, so merging the chunks in order gives the books
+ *         in the same order as a sequential load.
+ *  @param[in] data. The contents of the file.
+ *  @param[in] size. The size of the file.
+ *  @param[in] search_mode. The search mode of the books.
+ *  @param[in] threads. The maximum number of threads, 0 to use every core.
+ *  @return The books of every chunk.
+ */
+template<class Key>
+std::vector<std::vector<Key>> ParseDatabase(const char* data, size_t size, int search_mode, unsigned threads = 0) {
+  const char* end = data + size;
+  const char* begin = SkipLines(data, end, 2);
+  size_t bytes = end - begin;
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, bytes / kMinLoaderChunkSize));
+  // Every chunk but the first starts after the first line break past its even share of the file
+  std::vector<const char*> bounds(chunks + 1, end);
+  bounds[0] = begin;
+  for (size_t i = 1; i < chunks; ++i) {
+    const char* split = std::max(bounds[i - 1], begin + bytes * i / chunks);
+    bounds[i] = split == begin ? begin : SkipLines(split - 1, end, 1);
+  }
+  std::vector<std::vector<Key>> books(chunks);
+  std::vector<std::thread> workers;
+  workers.reserve(chunks - 1);
+  for (size_t i = 1; i < chunks; ++i) {
+    workers.emplace_back(ParseChunk<Key>, bounds[i], bounds[i + 1], search_mode, std::ref(books[i]));
+  }
+  ParseChunk(bounds[0], bounds[1], search_mode, books[0]);
+  for (std::thread& worker : workers) worker.join();
+  return books;
+}
+
+#endif
@@ -0,0 +1,347 @@
+#ifndef TITLE_INDEX_H
+#define TITLE_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "secondary_index.h"
+
+// Index of the books of a table by the characters of their titles, to search
+// the titles that start with a text or that are a few typos away from it
+// without going through the whole table. It is a radix trie whose nodes are
+// stored in a vector and linked by their positions in it: every node is the
+// run of characters that the titles under it share after the ones of its
+// parent, so a chain of nodes with a single child is kept as one node, and the
+// books whose title ends in a node are listed apart. The characters of a node
+// are viewed in the title of one of its books, stored in the arena of the
+// table. The titles are compared without the case of the ASCII letters, and
+// the typos are counted in bytes.
+
+// Number of typos over which the similar titles are not searched
+const unsigned kMaxTitleDistance = 3;
+
+/** @brief Gets the character a title is compared by, without its case */
+inline char FoldTitleChar(char c) { return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c; }
+
+class TitleIndex {
+ public:
+  TitleIndex() : nodes_(1) {}
+  void Add(const IndexedBook& book);
+  void Remove(const IndexedBook& book);
+  template<class Visitor> void ForEachWithPrefix(std::string_view prefix, Visitor&& visit) const;
+  template<class Visitor> void ForEachSimilar(std::string_view title, unsigned max_distance, Visitor&& visit) const;
+  size_t GetNodeCount() const { return nodes_.size() - free_nodes_.size(); }
+ private:
+  static const uint32_t kNone = UINT32_MAX;
+  struct Node {
+    std::string_view Label() const { return std::string_view(label, length); }
+    // Children are linked by next_sibling in the order of their first characters
+    uint32_t first_child = kNone;
+    uint32_t next_sibling = kNone;
+    // Position in books_ of the books whose title ends in the node
+    uint32_t books = kNone;
+    uint32_t length = 0;
+    const char* label = nullptr;
+  };
+  uint32_t NewNode(std::string_view label);
+  void FreeNode(uint32_t node);
+  uint32_t FindChild(uint32_t node, char first, uint32_t& previous) const;
+  uint32_t FindNode(std::string_view title, bool whole, std::vector<uint32_t>* path = nullptr) const;
+  void Link(uint32_t parent, uint32_t previous, uint32_t child);
+  void Compact(const std::vector<uint32_t>& path);
+  template<class Visitor> bool VisitSubtree(uint32_t node, Visitor& visit) const;
+  template<class Visitor> void VisitSimilar(uint32_t node, std::string_view title, unsigned max_distance,
+                                            std::vector<std::vector<unsigned>>& rows, size_t depth, Visitor& visit) const;
+  // The first node is the root, the empty title
+  std::vector<Node> nodes_;
+  std::vector<std::vector<IndexedBook>> books_;
+  // Positions of the nodes and book lists freed by Remove(), reused by Add()
+  std::vector<uint32_t> free_nodes_;
+  std::vector<uint32_t> free_books_;
+};
+
+/** @brief Gets the number of characters two texts share at their start, without their case */
+inline size_t CommonTitlePrefix(std::string_view a, std::string_view b) {
+  size_t length = std::min(a.size(), b.size()), i = 0;
+  while (i < length && FoldTitleChar(a[i]) == FoldTitleChar(b[i])) ++i;
+  return i;
+}
+
+/** @brief Creates a node, reusing a freed position if there is one
+ *  @param[in] label. The characters of the node, viewed in the arena of the table.
+ *  @return The position of the node.
+ */
+inline uint32_t TitleIndex::NewNode(std::string_view label) {
+  uint32_t node;
+  if (free_nodes_.empty()) {
+    node = uint32_t(nodes_.size());
+    nodes_.emplace_back();
+  }
+  else {
+    node = free_nodes_.back();
+    free_nodes_.pop_back();
+    nodes_[node] = Node();
+  }
+  nodes_[node].label = label.data();
+  nodes_[node].length = uint32_t(label.size());
+  return node;
+}
+
+/** @brief Frees a node that is no longer linked, and its list of books */
+inline void TitleIndex::FreeNode(uint32_t node) {
+  if (nodes_[node].books != kNone) {
+    books_[nodes_[node].books] = std::vector<IndexedBook>();
+    free_books_.push_back(nodes_[node].books);
+  }
+  nodes_[node] = Node();
+  free_nodes_.push_back(node);
+}
+
+/** @brief Finds the child of a node whose characters start by one given
+ *  @param[in] node. The node.
+ *  @param[in] first. The character, already folded.
+ *  @param[out] previous. The last child before the position of the character, kNone if there is none.
+ *  @return The position of the child, kNone if there is none.
+ */
+inline uint32_t TitleIndex::FindChild(uint32_t node, char first, uint32_t& previous) const {
+  previous = kNone;
+  for (uint32_t child = nodes_[node].first_child; child != kNone; child = nodes_[child].next_sibling) {
+    unsigned char label = FoldTitleChar(nodes_[child].label[0]);
+    if (label == (unsigned char)first) return child;
+    if (label > (unsigned char)first) break;
+    previous = child;
+  }
+  return kNone;
+}
+
+/** @brief Finds the node of a title
+ *  @param[in] title. The title.
+ *  @param[in] whole. Whether the title must end in the node, or it may end
+ *             inside its characters, as a prefix of the titles under it.
+ *  @param[out] path. If given, the nodes from the root to the one found.
+ *  @return The position of the node, kNone if no title starts with the one given.
+ */
+inline uint32_t TitleIndex::FindNode(std::string_view title, bool whole, std::vector<uint32_t>* path) const {
+  uint32_t node = 0, previous;
+  if (path != nullptr) path->assign(1, node);
+  for (size_t i = 0; i < title.size(); ) {
+    node = FindChild(node, FoldTitleChar(title[i]), previous);
+    if (node == kNone) return kNone;
+    std::string_view label = nodes_[node].Label();
+    size_t common = CommonTitlePrefix(label, title.substr(i));
+    if (common < label.size() && (whole || i + common < title.size())) return kNone;
+    if (path != nullptr) path->push_back(node);
+    i += common;
+  }
+  return node;
+}
+
+/** @brief Links a node as the child of another after one of its children
+ *  @param[in] parent. The parent.
+ *  @param[in] previous. The child it goes after, kNone to make it the first one.
+ *  @param[in] child. The node linked, whose next sibling is set.
+ */
+inline void TitleIndex::Link(uint32_t parent, uint32_t previous, uint32_t child) {
+  uint32_t& link = previous == kNone ? nodes_[parent].first_child : nodes_[previous].next_sibling;
+  nodes_[child].next_sibling = link;
+  link = child;
+}
+
+/** @brief Adds a book to the index. The title follows the nodes that match
+ *         it, a node whose characters only match in part is split where they
+ *         stop matching, and the rest of the title becomes a new node.
+ *  @param[in] book. The book, whose strings are stored in the arena of the table.
+ */
+inline void TitleIndex::Add(const IndexedBook& book) {
+  std::string_view title = book.name;
+  uint32_t node = 0, previous;
+  for (size_t i = 0; i < title.size(); ) {
+    uint32_t child = FindChild(node, FoldTitleChar(title[i]), previous);
+    if (child == kNone) {
+      child = NewNode(title.substr(i));
+      Link(node, previous, child);
+      node = child;
+      break;
+    }
+    std::string_view label = nodes_[child].Label();
+    size_t common = CommonTitlePrefix(label, title.substr(i));
+    if (common < label.size()) {
+      // The shared characters become a new node, the parent of the old one
+      uint32_t middle = NewNode(label.substr(0, common));
+      uint32_t& link = previous == kNone ? nodes_[node].first_child : nodes_[previous].next_sibling;
+      link = middle;
+      nodes_[middle].next_sibling = nodes_[child].next_sibling;
+      nodes_[middle].first_child = child;
+      nodes_[child].next_sibling = kNone;
+      nodes_[child].label += common;
+      nodes_[child].length -= uint32_t(common);
+      child = middle;
+    }
+    node = child;
+    i += common;
+  }
+  if (nodes_[node].books == kNone) {
+    if (free_books_.empty()) {
+      nodes_[node].books = uint32_t(books_.size());
+      books_.emplace_back();
+    }
+    else {
+      nodes_[node].books = free_books_.back();
+      free_books_.pop_back();
+    }
+  }
+  books_[nodes_[node].books].push_back(book);
+}
+
+/** @brief Removes a book from the index. A node left without books is freed
+ *         if it has no children, or merged with its child if it has one.
+ *  @param[in] book. The book.
+ */
+inline void TitleIndex::Remove(const IndexedBook& book) {
+  std::vector<uint32_t> path;
+  uint32_t node = FindNode(book.name, true, &path);
+  if (node == kNone || nodes_[node].books == kNone) return;
+  std::vector<IndexedBook>& books = books_[nodes_[node].books];
+  for (auto entry = books.begin(); entry != books.end(); ++entry) {
+    if (entry->name == book.name && entry->author == book.author) {
+      books.erase(entry);
+      if (books.empty()) {
+        books = std::vector<IndexedBook>();
+        free_books_.push_back(nodes_[node].books);
+        nodes_[node].books = kNone;
+        Compact(path);
+      }
+      return;
+    }
+  }
+}
+
+/** @brief Frees the last node of a path if it has neither books nor children,
+ *         and merges with its only child every node of the path left without
+ *         books and with a single child, the root apart.
+ *  @param[in] path. The nodes from the root to the one that has lost its books.
+ */
+inline void TitleIndex::Compact(const std::vector<uint32_t>& path) {
+  for (size_t depth = path.size() - 1; depth > 0; --depth) {
+    uint32_t node = path[depth], parent = path[depth - 1];
+    Node& current = nodes_[node];
+    if (current.books != kNone) return;
+    uint32_t previous = kNone;
+    uint32_t* link = &nodes_[parent].first_child;
+    while (*link != node) {
+      previous = *link;
+      link = &nodes_[previous].next_sibling;
+    }
+    if (current.first_child == kNone) {
+      // The parent may be left with a single child, so the path is compacted upwards
+      *link = current.next_sibling;
+      FreeNode(node);
+      continue;
+    }
+    uint32_t child = current.first_child;
+    if (nodes_[child].next_sibling != kNone) return;
+    // The characters of the child follow the ones of the node in the title they are viewed in
+    nodes_[child].label -= current.length;
+    nodes_[child].length += current.length;
+    nodes_[child].next_sibling = current.next_sibling;
+    *link = child;
+    FreeNode(node);
+    return;
+  }
+}
+
+/** @brief Visits the books of a node and of its descendants in the order of their titles
+ *  @param[in] node. The node.
+ *  @param[in] visit. The function called with every book, which returns false to stop.
+ *  @return False if the visit has been stopped, true otherwise.
+ */
+template<class Visitor>
+bool TitleIndex::VisitSubtree(uint32_t node, Visitor& visit) const {
+  if (nodes_[node].books != kNone) {
+    for (const IndexedBook& book : books_[nodes_[node].books]) {
+      if (!visit(book)) return false;
+    }
+  }
+  for (uint32_t child = nodes_[node].first_child; child != kNone; child = nodes_[child].next_sibling) {
+    if (!VisitSubtree(child, visit)) return false;
+  }
+  return true;
+}
+
+/** @brief Visits the books whose title starts with a text, in the order of their titles
+ *  @param[in] prefix. The text.
+ *  @param[in] visit. The function called with every book, which returns false to stop.
+ */
+template<class Visitor>
+void TitleIndex::ForEachWithPrefix(std::string_view prefix, Visitor&& visit) const {
+  uint32_t node = FindNode(prefix, false);
+  if (node != kNone) VisitSubtree(node, visit);
+}
+
+/** @brief Visits the books whose title is at most some typos away from a text.
+ *         The trie is walked computing the edit distance from the title of
+ *         every node to the text, one row of the table of the distances per
+ *         character, and a subtree is skipped when every distance of a row
+ *         is over the maximum, as the titles under it can only be further away.
+ *  @param[in] title. The text.
+ *  @param[in] max_distance. The maximum number of characters inserted, deleted
+ *             or replaced, at most kMaxTitleDistance.
+ *  @param[in] visit. The function called with every book and its distance.
+ */
+template<class Visitor>
+void TitleIndex::ForEachSimilar(std::string_view title, unsigned max_distance, Visitor&& visit) const {
+  std::string folded(title);
+  for (char& c : folded) c = FoldTitleChar(c);
+  max_distance = std::min(max_distance, kMaxTitleDistance);
+  // The row of the root: the distance from the empty title to every prefix of the text
+  std::vector<std::vector<unsigned>> rows(1, std::vector<unsigned>(folded.size() + 1));
+  for (size_t i = 0; i <= folded.size(); ++i) rows[0][i] = unsigned(i);
+  if (folded.size() <= max_distance && nodes_[0].books != kNone) {
+    for (const IndexedBook& book : books_[nodes_[0].books]) visit(book, unsigned(folded.size()));
+  }
+  for (uint32_t child = nodes_[0].first_child; child != kNone; child = nodes_[child].next_sibling) {
+    VisitSimilar(child, folded, max_distance, rows, 0, visit);
+  }
+}
+
+/** @brief Visits the books of a node and of its descendants that are close enough to a text
+ *  @param[in] node. The node.
+ *  @param[in] title. The text, already folded.
+ *  @param[in] max_distance. The maximum distance.
+ *  @param[in,out] rows. The rows of the characters of the ancestors of the
+ *                 node, reused by the calls at the same depths.
+ *  @param[in] depth. The number of characters of the ancestors of the node.
+ *  @param[in] visit. The function called with every book and its distance.
+ */
+template<class Visitor>
+void TitleIndex::VisitSimilar(uint32_t node, std::string_view title, unsigned max_distance,
+                              std::vector<std::vector<unsigned>>& rows, size_t depth, Visitor& visit) const {
+  std::string_view label = nodes_[node].Label();
+  for (char c : label) {
+    char folded = FoldTitleChar(c);
+    ++depth;
+    if (rows.size() <= depth) rows.emplace_back(title.size() + 1);
+    const std::vector<unsigned>& previous = rows[depth - 1];
+    std::vector<unsigned>& row = rows[depth];
+    row[0] = unsigned(depth);
+    unsigned lowest = row[0];
+    for (size_t i = 1; i <= title.size(); ++i) {
+      unsigned replaced = previous[i - 1] + (title[i - 1] != folded);
+      row[i] = std::min({previous[i] + 1, row[i - 1] + 1, replaced});
+      lowest = std::min(lowest, row[i]);
+    }
+    if (lowest > max_distance) return;
+  }
+  unsigned distance = rows[depth][title.size()];
+  if (distance <= max_distance && nodes_[node].books != kNone) {
+    for (const IndexedBook& book : books_[nodes_[node].books]) visit(book, distance);
+  }
+  for (uint32_t child = nodes_[node].first_child; child != kNone; child = nodes_[child].next_sibling) {
+    VisitSimilar(child, title, max_distance, rows, depth, visit);
+  }
+}
+
+#endif
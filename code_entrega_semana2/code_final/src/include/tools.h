@@ -10,11 +10,19 @@
 #include <algorithm>
 #include <ctime>
 #include <atomic>
+#include <climits>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 #include <map>
 
 #include "book.h"
 #include "hashtable.h"
+#include "journal.h"
 
 #define ERROREXIT(message) std::cout << "./Hash: " << message << "\n" << "./Hash -h to get help\n"; return false
 
@@ -28,9 +36,27 @@ const std::string MAGENTA = "\033[95m";
 const std::string CYAN = "\033[96m";
 const std::string RESET = "\033[0m";
 
+// Text database of the library and its binary snapshot
+const std::string DATABASE_FILE = "library.dat";
+const std::string SNAPSHOT_FILE = "library.snap";
+// Changes saved since the database was last written
+const std::string JOURNAL_FILE = "library.journal";
+// Saving writes the whole database again once the journal is over this ratio of its size, and this number of bytes
+const double JOURNAL_COMPACTION_RATIO = 0.5;
+const size_t MIN_JOURNAL_COMPACTION = 1 << 20;
+
+// Titles suggested by the autocompletion of the menu, and typos allowed when no title starts with the text
+const size_t MAX_SUGGESTIONS = 10;
+const unsigned SUGGESTION_TYPOS = 2;
+
 bool CheckCompatibility(const std::map<std::string, int>& parameters);
 bool CheckCorrectParameters(int argc, const std::vector<std::string>& args, std::map<std::string, int>& parameters);
-Table<Book>* CreateHashTable(const std::map<std::string, int>& parameters);
+Table<Book>* CreateHashTable(const std::map<std::string, int>& parameters, bool interactive = true);
+bool LoadDatabase(Table<Book>* hash_table);
+bool SaveDatabase(const Table<Book>* hash_table);
+void CompactDatabase(const Table<Book>* hash_table);
+bool WaitForCompaction();
 void Menu(Table<Book>* hash_table);
+int RunBatch(Table<Book>* hash_table, std::istream& in, std::ostream& out);
 
 #endif
\ No newline at end of file
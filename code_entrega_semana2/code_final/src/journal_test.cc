@@ -0,0 +1,87 @@
+#include "include/tools.h"
+
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <sys/resource.h>
+
+// Test of the saving of the library when the journal can't be committed. It
+// runs in a directory of its own under /tmp, as the files of the library are
+// found in the working directory, and exits with 1 if a check fails.
+
+// Globals of tools.cc
+extern int SEARCHMODE;
+extern Journal JOURNAL;
+
+/** @brief Writes the result of a check and counts it if it fails
+ *  @param[in] passed. Whether the check has passed.
+ *  @param[in] name. What the check verifies.
+ *  @param[in,out] failed. The number of checks failed.
+ */
+void Check(bool passed, const std::string& name, int& failed) {
+  std::cout << (passed ? "ok   " : "FAIL ") << name << std::endl;
+  if (!passed) ++failed;
+}
+
+/** @brief Creates a table for the library of the test */
+Table<Book>* NewTestTable() {
+  Table<Book>* table = new HashTable<Book, DynamicSequence<Book>, ModFunction<Book>>(101, ModFunction<Book>(101));
+  table->SetKeyMode(SEARCHMODE);
+  table->SetSearchMode(SEARCHMODE);
+  return table;
+}
+
+/** @brief Runs some batch commands on a table
+ *  @return The result of the last command.
+ */
+std::string Run(Table<Book>* table, const std::string& commands) {
+  std::istringstream in(commands);
+  std::ostringstream out;
+  RunBatch(table, in, out);
+  std::string results = out.str();
+  size_t last = results.rfind('\n', results.size() - 2);
+  return results.substr(last == std::string::npos ? 0 : last + 1);
+}
+
+/** @brief Saves a change while the journal can't grow, so its commit fails
+ *         and the whole table is written instead, then saves another change
+ *         once the journal can be committed again, and loads the library back:
+ *         the first change must not be applied twice.
+ *  @param[in,out] failed. The number of checks failed.
+ */
+void TestCommitFailure(int& failed) {
+  std::unique_ptr<Table<Book>> table(NewTestTable());
+  Check(PublishFile(DATABASE_FILE, "Nombre del libro | Autor | Estado | Precio | Reservas\n"), "database written", failed);
+  Check(LoadDatabase(table.get()) && JOURNAL.IsOpen(), "journal opened", failed);
+  // The journal grows over the size of the database, which stays empty
+  std::string changes;
+  for (int i = 0; i < 500; ++i) changes += "insert Temporal " + std::to_string(i) + " | Autor | 1\ndelete Temporal " + std::to_string(i) + " | Autor\n";
+  Check(Run(table.get(), changes + "save\n") == "save ok\n", "journal committed", failed);
+  // Over the limit, the writes fail: the long change can't be committed, but the checkpoint and the database can be written
+  std::string title(400, 'T');
+  struct rlimit limit, previous;
+  getrlimit(RLIMIT_FSIZE, &previous);
+  limit = previous;
+  limit.rlim_cur = JOURNAL.GetBytes() + 100;
+  std::signal(SIGXFSZ, SIG_IGN);
+  setrlimit(RLIMIT_FSIZE, &limit);
+  Check(Run(table.get(), "insert " + title + " | Autor | 5\nsave\n") == "save ok\n", "table written when the journal can't be committed", failed);
+  setrlimit(RLIMIT_FSIZE, &previous);
+  Check(Run(table.get(), "insert Otro | Autor | 2\nsave\n") == "save ok\n", "journal committed again", failed);
+  WaitForCompaction();
+
+  std::unique_ptr<Table<Book>> loaded(NewTestTable());
+  Check(LoadDatabase(loaded.get()), "library loaded back", failed);
+  Check(loaded->GetSize() == 2, "every change applied once (" + std::to_string(loaded->GetSize()) + " books)", failed);
+}
+
+int main() {
+  std::filesystem::path directory = std::filesystem::temp_directory_path() / ("journal_test_" + std::to_string(getpid()));
+  std::filesystem::create_directory(directory);
+  std::filesystem::current_path(directory);
+  int failed = 0;
+  TestCommitFailure(failed);
+  std::filesystem::current_path(std::filesystem::temp_directory_path());
+  std::filesystem::remove_all(directory);
+  return failed == 0 ? 0 : 1;
+}
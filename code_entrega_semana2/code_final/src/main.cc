@@ -15,13 +15,29 @@ bool ConfigureProgram(std::vector<std::string>& args) {
   return true;
 }
 
+// ./Hash                  --> Interactive menu
+// ./Hash -batch <file|->  --> Runs the commands of a file, or of the standard input, without the menu
 int main(int argc, char* argv[]) {
   srand(time(NULL));
+  bool batch = argc == 3 && std::string(argv[1]) == "-batch";
+  if (argc != 1 && !batch) {
+    std::cerr << "Usage: ./Hash [-batch <file|->]" << std::endl;
+    return 1;
+  }
   std::map<std::string, int> parameters;
   std::vector<std::string> args;
   if (ConfigureProgram(args) && CheckCorrectParameters(args.size(), args, parameters)) {
-    Table<Book>* hash_table = CreateHashTable(parameters);
+    Table<Book>* hash_table = CreateHashTable(parameters, !batch);
     if (hash_table == nullptr) return 1;
+    if (batch) {
+      int errors = 1;
+      std::ifstream file;
+      if (std::string(argv[2]) != "-") file.open(argv[2]);
+      if (std::string(argv[2]) != "-" && !file) std::cerr << "Error opening the command file " << argv[2] << std::endl;
+      else if (LoadDatabase(hash_table)) errors = RunBatch(hash_table, file.is_open() ? file : std::cin, std::cout);
+      delete hash_table;
+      return errors == 0 ? 0 : 1;
+    }
     Menu(hash_table);
     delete hash_table;
     std::cout << MAGENTA << "Program ended." << RESET << std::endl;
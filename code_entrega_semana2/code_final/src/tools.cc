@@ -2,11 +2,17 @@
 
 bool OPEN, LIBRARIAN;
 int SEARCHMODE;
+Journal JOURNAL;
+// Thread that writes the whole table to the database, and whether it is running and has written it
+std::thread COMPACTION;
+std::atomic<bool> COMPACTING(false);
+std::atomic<bool> COMPACTED(true);
 
 /** @brief Checks if the parameters are compatible with the hash function
  *         type specified. If the hash function is close, the block size
  *         and the exploration function must be specified, if is open, it
- *         must not be specified.
+ *         must not be specified, and if it is cuckoo, only the block size
+ *         must be specified.
  *  @param[in] parameters. The parameters to check.
  *  @return True if the parameters are compatible, false otherwise.
  */
@@ -17,6 +23,9 @@ bool CheckCompatibility(const std::map<std::string, int>& parameters) {
   if (parameters.at("-hash") == 0 && (parameters.find("-bs") != parameters.end() || parameters.find("-fe") != parameters.end())) {
     ERROREXIT("If the hash function is open, the block size and the exploration function must not be specified");
   }
+  if (parameters.at("-hash") == 2 && (parameters.find("-bs") == parameters.end() || parameters.find("-fe") != parameters.end())) {
+    ERROREXIT("If the hash function is cuckoo, the block size must be specified and the exploration function must not");
+  }
   return true;
 }
 
@@ -27,12 +36,12 @@ bool CheckCompatibility(const std::map<std::string, int>& parameters) {
  *  @return True if the parameters are correct, false otherwise.
  */
 bool CheckCorrectParameters(int argc, const std::vector<std::string>& args, std::map<std::string, int>& parameters) {
-  if (argc != 9 && argc != 13) {
+  if (argc != 9 && argc != 11 && argc != 13 && argc != 15 && argc != 17) {
     ERROREXIT("Incorrect number of parameters");
   }
   for (int i = 1; i < argc; i += 2) {
     std::string param = args[i];
-    if (param != "-sm" && param != "-ts" && param != "-fd" && param != "-hash" && param != "-bs" && param != "-fe") {
+    if (param != "-sm" && param != "-ts" && param != "-fd" && param != "-hash" && param != "-bs" && param != "-fe" && param != "-lf" && param != "-aux") {
       ERROREXIT("Invalid parameter " + param);
     }
     int value;
@@ -52,6 +61,10 @@ bool CheckCorrectParameters(int argc, const std::vector<std::string>& args, std:
         value = 1;
         OPEN = false;
       }
+      else if (args[i + 1] == "cuckoo") {
+        value = 2;
+        OPEN = false;
+      }
       else {
         ERROREXIT("Invalid value for " + param);
       }
@@ -70,91 +83,261 @@ bool CheckCorrectParameters(int argc, const std::vector<std::string>& args, std:
     else if (param == "-fd" && (value < 0 || value > 2)) {
       ERROREXIT("The value of " + param + " must be between 0 and 2");
     }
-    // 0 -> Open; 1 -> Close
-    else if (param == "-hash" && (value < 0 || value > 1)) {
-      ERROREXIT("The value of " + param + " must be between 0 and 1");
+    // 0 -> Open; 1 -> Close; 2 -> Cuckoo
+    else if (param == "-hash" && (value < 0 || value > 2)) {
+      ERROREXIT("The value of " + param + " must be between 0 and 2");
+    }
+    // 0 -> Lineal; 1 -> Quadratic; 2 -> Double dispersion; 3 -> Redispersion; 4 -> Robin Hood
+    else if (param == "-fe" && (value < 0 || value > 4)) {
+      ERROREXIT("The value of " + param + " must be between 0 and 4");
     }
-    // 0 -> Lineal; 1 -> Quadratic; 2 -> Double dispersion; 3 -> Redispersion
-    else if (param == "-fe" && (value < 0 || value > 3)) {
-      ERROREXIT("The value of " + param + " must be between 0 and 3");
+    // Auxiliar function of the double dispersion: 0 -> Mod; 1 -> Sum; 2 -> Random
+    else if (param == "-aux" && (value < 0 || value > 2)) {
+      ERROREXIT("The value of " + param + " must be between 0 and 2");
     }
     parameters[args[i]] = value;
   }
   return CheckCompatibility(parameters);
 }
 
-/** @brief Creates a hash table with the parameters specified.
- *  @param[in] parameters. The parameters to create the hash table.
+/** @brief Creates a close hash table with the disperse and exploration functions as policies.
+ *  @param[in] table_size. The number of blocks of the table.
+ *  @param[in] block_size. The number of slots of each block.
  *  @return A pointer to the hash table created.
  */
-Table<Book>* CreateHashTable(const std::map<std::string, int>& parameters) {
-  DisperseFunction<Book>* disperse_function = nullptr;
+template<class Fd, class Fe>
+Table<Book>* NewCloseHashTable(unsigned table_size, unsigned block_size) {
+  return new HashTable<Book, FlatSequence<Book>, Fd, Fe>(table_size, Fd(table_size), Fe(table_size), block_size);
+}
+
+/** @brief Creates a close hash table with the exploration function specified.
+ *  @param[in] table_size. The number of blocks of the table.
+ *  @param[in] block_size. The number of slots of each block.
+ *  @param[in] exploration. The exploration function (-fe).
+ *  @param[in] auxiliar. The auxiliar disperse function of the double dispersion.
+ *  @return A pointer to the hash table created, nullptr if a function is not valid.
+ */
+template<class Fd>
+Table<Book>* NewCloseHashTable(unsigned table_size, unsigned block_size, int exploration, int auxiliar) {
+  switch (exploration) {
+    case 0: return NewCloseHashTable<Fd, LinearFunction<Book>>(table_size, block_size);
+    case 1: return NewCloseHashTable<Fd, QuadraticFunction<Book>>(table_size, block_size);
+    case 2:
+      switch (auxiliar) {
+        case 0: return NewCloseHashTable<Fd, DoubleDisperseFunction<Book, ModFunction<Book>>>(table_size, block_size);
+        case 1: return NewCloseHashTable<Fd, DoubleDisperseFunction<Book, SumFunction<Book>>>(table_size, block_size);
+        case 2: return NewCloseHashTable<Fd, DoubleDisperseFunction<Book, RandFunction<Book>>>(table_size, block_size);
+      }
+      break;
+    case 3: return NewCloseHashTable<Fd, RedispersionFunction<Book>>(table_size, block_size);
+    case 4: return NewCloseHashTable<Fd, RobinHoodFunction<Book>>(table_size, block_size);
+  }
+  return nullptr;
+}
+
+/** @brief Creates an open, close or cuckoo hash table with the disperse function specified.
+ *  @param[in] parameters. The parameters to create the hash table.
+ *  @param[in] auxiliar. The auxiliar disperse function of the double dispersion.
+ *  @return A pointer to the hash table created, nullptr if a function is not valid.
+ */
+template<class Fd>
+Table<Book>* NewHashTable(const std::map<std::string, int>& parameters, int auxiliar) {
+  unsigned table_size = parameters.at("-ts");
+  if (OPEN) return new HashTable<Book, DynamicSequence<Book>, Fd>(table_size, Fd(table_size));
+  if (parameters.at("-hash") == 2) return new HashTable<Book, CuckooSequence<Book>, Fd>(table_size, Fd(table_size), parameters.at("-bs"));
+  return NewCloseHashTable<Fd>(table_size, parameters.at("-bs"), parameters.at("-fe"), auxiliar);
+}
+
+/** @brief Shows the configuration of the table that is going to be created.
+ *  @param[in] parameters. The parameters to create the hash table.
+ *  @param[in] max_load_factor. The max load factor of the table.
+ */
+void ShowConfiguration(const std::map<std::string, int>& parameters, double max_load_factor) {
   std::cout << MAGENTA << "Searching by: ";
   if (SEARCHMODE == 0)      std::cout << "Name" << RESET << std::endl;
   else if (SEARCHMODE == 1) std::cout << "Author" << RESET << std::endl;
   else                      std::cout << "Name and Author" << RESET << std::endl;
   std::cout << GREEN << "Table size: " << parameters.at("-ts") << RESET << std::endl;
+  if (max_load_factor == 0) std::cout << GREEN << "Max load factor: None" << RESET << std::endl;
+  else                      std::cout << GREEN << "Max load factor: " << max_load_factor << RESET << std::endl;
   switch (parameters.at("-fd")) {
-    case 0:
-      std::cout << GREEN << "Disperse function: Mod" << RESET << std::endl;
-      disperse_function = new ModFunction<Book>(parameters.at("-ts"));
-      break;
-    case 1:
-      std::cout << GREEN << "Disperse function: Sum" << RESET << std::endl;
-      disperse_function = new SumFunction<Book>(parameters.at("-ts"));
-      break;
-    case 2:
-      std::cout << GREEN << "Disperse function: Random" << RESET << std::endl;
-      disperse_function = new RandFunction<Book>(parameters.at("-ts"));
-      break;    
-    default:
-      break;
-  }
-  if (disperse_function == nullptr) {
-    std::cerr << "Error creating the hash table" << std::endl;
-    return nullptr;
+    case 0: std::cout << GREEN << "Disperse function: Mod" << RESET << std::endl; break;
+    case 1: std::cout << GREEN << "Disperse function: Sum" << RESET << std::endl; break;
+    case 2: std::cout << GREEN << "Disperse function: Random" << RESET << std::endl; break;
   }
-  if (!OPEN) {
-    ExplorationFunction<Book>* exploration_function = nullptr;
-    std::cout << GREEN << "Block size: " << parameters.at("-bs") << RESET << std::endl;
+  if (!OPEN) std::cout << GREEN << "Block size: " << parameters.at("-bs") << RESET << std::endl;
+  if (parameters.at("-hash") == 1) {
     switch (parameters.at("-fe")) {
-      case 0:
-        std::cout << GREEN << "Exploration function: Linear" << RESET << std::endl;
-        exploration_function = new LinearFunction<Book>(parameters.at("-ts"));
-        break;
-      case 1:
-        std::cout << GREEN << "Exploration function: Quadratic" << RESET << std::endl;
-        exploration_function = new QuadraticFunction<Book>(parameters.at("-ts"));
-        break;
-      case 2:
-        std::cout << GREEN << "Exploration function: Double dispersion" << RESET << std::endl;
-        DisperseFunction<Book>* auxiliar_function;
-        int option;
-        std::cout << std::endl << BLUE << "0 --> Mod; 1 --> Sum; 2 --> Rand" << std::endl;
-        std::cout << RED << "WARNING: " << RESET << "Double dispersion selected, introduce an auxiliar disperse function: ";
-        std::cin >> option;
-        switch (option) {
-          case 0: auxiliar_function = new ModFunction<Book>(parameters.at("-ts")); break;
-          case 1: auxiliar_function = new SumFunction<Book>(parameters.at("-ts")); break;
-          case 2: auxiliar_function = new RandFunction<Book>(parameters.at("-ts")); break;
-          default: std::cout << RED << "The option is not valid" << RESET << std::endl; return nullptr;
-        }
-        exploration_function = new DoubleDisperseFunction<Book>(parameters.at("-ts"), auxiliar_function);
-        break;
-      case 3:
-        std::cout << GREEN << "Exploration function: Redispersion" << RESET << std::endl;
-        exploration_function = new RedispersionFunction<Book>(parameters.at("-ts"));
-        break;
+      case 0: std::cout << GREEN << "Exploration function: Linear" << RESET << std::endl; break;
+      case 1: std::cout << GREEN << "Exploration function: Quadratic" << RESET << std::endl; break;
+      case 2: std::cout << GREEN << "Exploration function: Double dispersion" << RESET << std::endl; break;
+      case 3: std::cout << GREEN << "Exploration function: Redispersion" << RESET << std::endl; break;
+      case 4: std::cout << GREEN << "Exploration function: Robin Hood" << RESET << std::endl; break;
+    }
+  }
+}
+
+/** @brief Creates a hash table with the parameters specified. Every combination
+ *         of disperse and exploration functions is its own instantiation of the
+ *         HashTable, so the functions are inlined in its probe loops.
+ *  @param[in] parameters. The parameters to create the hash table.
+ *  @param[in] interactive. False to create the table without showing its
+ *             configuration or asking for the auxiliar function (-aux).
+ *  @return A pointer to the hash table created.
+ */
+Table<Book>* CreateHashTable(const std::map<std::string, int>& parameters, bool interactive) {
+  Table<Book>* hash_table = nullptr;
+  double max_load_factor = kDefaultMaxLoadFactor;
+  if (parameters.find("-lf") != parameters.end()) max_load_factor = parameters.at("-lf") / 100.0;
+  if (interactive) ShowConfiguration(parameters, max_load_factor);
+  int auxiliar = 0;
+  if (parameters.find("-aux") != parameters.end()) {
+    auxiliar = parameters.at("-aux");
+  }
+  else if (parameters.at("-hash") == 1 && parameters.at("-fe") == 2) {
+    if (!interactive) {
+      std::cerr << "The auxiliar function of the double dispersion must be specified with -aux" << std::endl;
+      return nullptr;
     }
-    if (exploration_function == nullptr) {
-      std::cerr << "Error creating the hash table" << std::endl;
+    std::cout << std::endl << BLUE << "0 --> Mod; 1 --> Sum; 2 --> Rand" << std::endl;
+    std::cout << RED << "WARNING: " << RESET << "Double dispersion selected, introduce an auxiliar disperse function: ";
+    std::cin >> auxiliar;
+    if (auxiliar < 0 || auxiliar > 2) {
+      std::cout << RED << "The option is not valid" << RESET << std::endl;
       return nullptr;
     }
-    std::cout << MAGENTA << "Hash Table: Close" << RESET << std::endl;
-    return new HashTable<Book>(parameters.at("-ts"), *disperse_function, *exploration_function, parameters.at("-bs"));
   }
-  std::cout << MAGENTA << "Hash Table: Open" << RESET << std::endl;
-  return new HashTable<Book, DynamicSequence<Book>>(parameters.at("-ts"), *disperse_function);
+  switch (parameters.at("-fd")) {
+    case 0: hash_table = NewHashTable<ModFunction<Book>>(parameters, auxiliar); break;
+    case 1: hash_table = NewHashTable<SumFunction<Book>>(parameters, auxiliar); break;
+    case 2: hash_table = NewHashTable<RandFunction<Book>>(parameters, auxiliar); break;
+  }
+  if (hash_table == nullptr) {
+    std::cerr << "Error creating the hash table" << std::endl;
+    return nullptr;
+  }
+  if (interactive) std::cout << MAGENTA << "Hash Table: " << (OPEN ? "Open" : parameters.at("-hash") == 1 ? "Close" : "Cuckoo") << RESET << std::endl;
+  hash_table->SetKeyMode(SEARCHMODE);
+  hash_table->SetSearchMode(SEARCHMODE);
+  hash_table->SetMaxLoadFactor(max_load_factor);
+  return hash_table;
+}
+
+/** @brief Applies a change of the journal to the table
+ *  @param[in] hash_table. The table.
+ *  @param[in] record. The change, as the journal writes it.
+ *  @return True if the change has been applied, false otherwise.
+ */
+bool ApplyJournalRecord(Table<Book>* hash_table, std::string_view record) {
+  std::string_view command = NextField(record, '|');
+  std::string_view name = NextField(record, '|');
+  std::string_view author = NextField(record, '|');
+  if (command == "insert") {
+    double price;
+    return ParsePrice(record, price) && hash_table->Insert(Book(name, author, price, SEARCHMODE));
+  }
+  if (command == "delete") return hash_table->Delete(BookKey(name, author, SEARCHMODE));
+  if (command == "reserve") {
+    std::string_view person = NextField(record, '|');
+    std::string_view start = NextField(record, '|');
+    int32_t start_day, return_day;
+    if (std::from_chars(start.data(), start.data() + start.size(), start_day).ec != std::errc() ||
+        std::from_chars(record.data(), record.data() + record.size(), return_day).ec != std::errc()) return false;
+    int index;
+    Book* book = hash_table->Find(BookKey(name, author, SEARCHMODE), index);
+    if (book == nullptr) return false;
+    book->AddReservation({ReaderName(person), Date(start_day), Date(return_day)});
+    return true;
+  }
+  return false;
+}
+
+/** @brief Loads the books of the library into the table and applies the
+ *         changes of the journal to them. The binary snapshot is used if it is
+ *         at least as recent as the text database, which is read otherwise.
+ *  @param[in] hash_table. The table to fill.
+ *  @return True if the books have been loaded, false otherwise.
+ */
+bool LoadDatabase(Table<Book>* hash_table) {
+  std::error_code error;
+  std::filesystem::file_time_type snapshot_time = std::filesystem::last_write_time(SNAPSHOT_FILE, error);
+  bool loaded = false;
+  uint64_t exhausted = hash_table->Stats().exhausted;
+  if (!error) {
+    std::filesystem::file_time_type database_time = std::filesystem::last_write_time(DATABASE_FILE, error);
+    loaded = (error || snapshot_time >= database_time) && hash_table->LoadSnapshot(SNAPSHOT_FILE);
+  }
+  if (!loaded && !hash_table->LoadFile(DATABASE_FILE)) {
+    std::cerr << "Error opening the database file" << std::endl;
+    return false;
+  }
+  if (hash_table->Stats().exhausted > exhausted) std::cout << "All possible indexes have been tried" << std::endl << std::endl;
+  int invalid = 0;
+  bool opened = JOURNAL.Open(JOURNAL_FILE, DATABASE_FILE, [&](std::string_view record) {
+    if (!ApplyJournalRecord(hash_table, record)) ++invalid;
+  });
+  // The library can still be used, and saving it writes the whole database
+  if (!opened) std::cerr << "Error opening the journal file" << std::endl;
+  if (invalid > 0) std::cerr << invalid << " changes of the journal couldn't be applied" << std::endl;
+  return true;
+}
+
+/** @brief Saves the changes made to the table since the last time. They are
+ *         committed to the journal, and once the journal has grown too big
+ *         compared to the database, the whole table is written again in the
+ *         background (see CompactDatabase()).
+ *  @param[in] hash_table. The table to save.
+ *  @return True if the changes have been saved, false otherwise.
+ */
+bool SaveDatabase(const Table<Book>* hash_table) {
+  if (JOURNAL.Commit()) {
+    std::error_code error;
+    uintmax_t database_size = std::filesystem::file_size(DATABASE_FILE, error);
+    double compaction_size = std::max(double(MIN_JOURNAL_COMPACTION), JOURNAL_COMPACTION_RATIO * (error ? 0 : database_size));
+    // The journal keeps growing while a compaction is running, and the next save starts another one
+    if (JOURNAL.GetBytes() >= compaction_size && !COMPACTING) CompactDatabase(hash_table);
+    return true;
+  }
+  // Without the journal, the changes are only saved by writing the whole table,
+  // which has them, so they are not committed again if the journal comes back
+  CompactDatabase(hash_table);
+  if (!WaitForCompaction()) return false;
+  JOURNAL.Discard();
+  return true;
+}
+
+/** @brief Writes the whole table to the text database and to the binary
+ *         snapshot the next start will load, and empties the journal of the
+ *         changes that are in them. Only the copy of the keys of the table is
+ *         made here: the files are written by another thread, while the table
+ *         keeps being used, and each one replaces the old one at once (see
+ *         PublishFile()). The compaction running, if any, is waited for first.
+ *  @param[in] hash_table. The table to save, which must live until the compaction finishes.
+ */
+void CompactDatabase(const Table<Book>* hash_table) {
+  if (!WaitForCompaction()) std::cerr << "Error writing the database" << std::endl;
+  COMPACTING = true;
+  // The changes committed up to here are in the copy of the keys
+  COMPACTION = std::thread([books = hash_table->CopyKeys(), key_mode = hash_table->GetKeyMode(), offset = JOURNAL.GetBytes(), journaled = JOURNAL.IsOpen()] {
+    auto for_each = [&books](auto&& visit) { for (const Book& book : books) visit(book); };
+    std::ostringstream database, snapshot;
+    WriteDatabase<Book>(database, for_each);
+    WriteSnapshot<Book>(snapshot, books.size(), key_mode, for_each);
+    std::string text = database.str();
+    // The journal tells which changes the new database has before it replaces the old one
+    COMPACTED = database.good() && snapshot.good() && (!journaled || JOURNAL.Checkpoint(offset, text)) &&
+                PublishFile(DATABASE_FILE, text) && PublishFile(SNAPSHOT_FILE, snapshot.str()) &&
+                (!journaled || JOURNAL.Rebase(offset, text));
+    COMPACTING = false;
+  });
+}
+
+/** @brief Waits until the compaction running, if any, finishes
+ *  @return False if the last compaction couldn't write the database, true otherwise.
+ */
+bool WaitForCompaction() {
+  if (COMPACTION.joinable()) COMPACTION.join();
+  return COMPACTED;
 }
 
 /** @brief Shows the options menu of the program.
@@ -163,12 +346,7 @@ Table<Book>* CreateHashTable(const std::map<std::string, int>& parameters) {
 void Menu(Table<Book>* hash_table) {
   char option;
   hash_table->SetSearchMode(SEARCHMODE);
-  std::ifstream datafile("library.dat");
-  if (!datafile) {
-    std::cerr << "Error opening the database file" << std::endl;
-    return;
-  }
-  hash_table->LoadFile(datafile);
+  if (!LoadDatabase(hash_table)) return;
   while (option != '4') {
     std::cout << YELLOW << std::endl;
     hash_table->Write(std::cout);
@@ -181,6 +359,9 @@ void Menu(Table<Book>* hash_table) {
     else             std::cout << "3. Delete a Book" << std::endl;
     if (!LIBRARIAN)  std::cout << "5. Log in as librarian" << std::endl;
     if (LIBRARIAN) { std::cout << "8. Save to Database" << std::endl; }
+                     std::cout << "6. Show the statistics of the table" << std::endl;
+                     std::cout << "7. Change the search mode" << std::endl;
+                     std::cout << "9. Autocomplete a title" << std::endl;
                      std::cout << "4. Quit" << std::endl;
                      std::cout << "Select an option: ";
     std::cin >> option;
@@ -204,6 +385,7 @@ void Menu(Table<Book>* hash_table) {
           std::cout << "The table is full!" << std::endl;
         }
         else if (hash_table->Insert(*new_book)) {
+          JOURNAL.LogInsert(*new_book);
           std::cout << GREEN << "The book has been inserted succesfully" << RESET << std::endl;
         }
         else {
@@ -214,24 +396,30 @@ void Menu(Table<Book>* hash_table) {
         break;
       }
       case '1': {
-        Book* book;
+        // Only the fields of the search mode are asked for
         std::string name, author;
-        std::cout << BLUE << "Insert the Book's name to search: " << RESET;
         std::cin.ignore();
-        std::getline(std::cin, name);
-        std::cout << BLUE << "Insert the Book's author to search: " << RESET;
-        std::getline(std::cin, author);
-        int index = 0;
+        if (hash_table->GetSearchMode() != 1) {
+          std::cout << BLUE << "Insert the Book's name to search: " << RESET;
+          std::getline(std::cin, name);
+        }
+        if (hash_table->GetSearchMode() != 0) {
+          std::cout << BLUE << "Insert the Book's author to search: " << RESET;
+          std::getline(std::cin, author);
+        }
+        std::vector<int> indexes;
         std::cout << std::endl;
-        book = new Book(name, author, 0.0, SEARCHMODE);
-        if (hash_table->Search(*book, index)) {
-          std::cout << GREEN << "The Book is in the hash table" << std::endl;
-          std::cout << "Position: " << index << RESET << std::endl;
+        std::vector<Book*> books = hash_table->FindAll(name, author, &indexes);
+        if (!books.empty()) {
+          std::cout << GREEN << (books.size() == 1 ? "The Book is in the hash table" : "The Books are in the hash table") << std::endl;
+          for (size_t i = 0; i < books.size(); ++i) {
+            std::cout << books[i]->GetName() << ", " << books[i]->GetAuthor() << ". Position: " << indexes[i] << std::endl;
+          }
+          std::cout << RESET;
         }
         else {
           std::cout << RED << "The Book is not in the hash table" << RESET << std::endl;
         }
-        delete book;
         break;
       }
       case '2': {
@@ -250,39 +438,37 @@ void Menu(Table<Book>* hash_table) {
           std::cout << BLUE << "Enter the author of the book to reserve: " << RESET;
           std::getline(std::cin, author);
           std::cout << std::endl;
-          book = new Book(name, author, 0.0, SEARCHMODE); 
           int index = 0;
-          if (hash_table->Search(*book, index)) {
+          // The reservation is made on the book stored in the table
+          book = hash_table->Find(BookKey(name, author, SEARCHMODE), index);
+          if (book != nullptr) {
             book->MakeReservation(newReservation); // Llama a MakeReservation
+            JOURNAL.LogReservation(book->GetName(), book->GetAuthor(), newReservation);
             book->ShowReservations(name); // Muestra la lista de reservas y fechas de disponibilidad
           } 
           else {
             std::cout << RED << "You can't reserve a book that doesn't exist in the database" << RESET << std::endl;
             break;
           }
-          Reservation previousReservation = previousReservations[name]; // Obtener la reserva anterior para este libro
           previousReservations[name] = newReservation; // Guarda los datos si se cambia de libro
-          delete book; // Liberar la memoria del objeto Book
         }
         break;
       }
       case '3': {
         if (LIBRARIAN) {
-          Book* book;
           std::string name, author;
           std::cout << BLUE << "Enter the name of the book to delete: " << RESET;
           std::cin.ignore();
           std::getline(std::cin, name);
           std::cout << BLUE << "Enter the author of the book to delete: " << RESET;
           std::getline(std::cin, author);
-          book = new Book(name, author, 0.0, SEARCHMODE);
-          if (hash_table->Delete(*book)) {
+          if (hash_table->Delete(BookKey(name, author, SEARCHMODE))) {
+            JOURNAL.LogDelete(name, author);
             std::cout << GREEN << "The book has been deleted succesfully" << RESET << std::endl;
           }
           else {
             std::cout << RED << "It wasn't possible to delete the book from the table" << RESET << std::endl;
           }
-          delete book;
         }
         else {
           Book* book;
@@ -296,9 +482,10 @@ void Menu(Table<Book>* hash_table) {
           std::cin >> newReturnDate;
 
           book = new Book(name, author, 0.0, SEARCHMODE);
-          book->ModifyReturnDate(newReturnDate); // Llama a ModifyReturnDate para modificar la fecha de entrega
-          
-          std::cout << GREEN << "Return date modified successfully to: "<< newReturnDate << RESET << std::endl;
+          // Llama a ModifyReturnDate para modificar la fecha de entrega
+          if (book->ModifyReturnDate(newReturnDate)) {
+            std::cout << GREEN << "Return date modified successfully to: "<< newReturnDate << RESET << std::endl;
+          }
           delete book;
         }
         break;
@@ -331,11 +518,32 @@ void Menu(Table<Book>* hash_table) {
           break;
         }
       }
+      case '6': {
+        std::cout << CYAN << "Size: " << hash_table->GetSize() << " books in " << hash_table->GetTableSize() << " blocks" << std::endl;
+        std::cout << hash_table->Stats() << RESET;
+        break;
+      }
+      case '7': {
+        int search_mode;
+        std::cout << BLUE << "Search by (0 -> Name; 1 -> Author; 2 -> Both): " << RESET;
+        if (std::cin >> search_mode && search_mode >= 0 && search_mode <= 2) {
+          hash_table->SetSearchMode(search_mode);
+          std::cout << GREEN << "Search mode changed" << RESET << std::endl;
+        }
+        else {
+          std::cin.clear();
+          std::cout << RED << "Invalid search mode" << RESET << std::endl;
+        }
+        break;
+      }
       case '8': {
         if (LIBRARIAN) {
-          std::ofstream file("library.dat");
-          hash_table->SaveToFile(file);
-          std::cout << GREEN << "Data saved successfully" << RESET << std::endl;
+          if (SaveDatabase(hash_table)) {
+            std::cout << GREEN << "Data saved successfully" << RESET << std::endl;
+          }
+          else {
+            std::cout << RED << "Error saving the data" << RESET << std::endl;
+          }
           break;
         }
         else {
@@ -343,9 +551,186 @@ void Menu(Table<Book>* hash_table) {
           break;
         }
       }
+      case '9': {
+        // The titles that start with the text, or the closest ones if there are none
+        std::string text;
+        std::cin.ignore();
+        std::cout << BLUE << "Insert the beginning of the title: " << RESET;
+        std::getline(std::cin, text);
+        std::vector<Book*> books = hash_table->FindByPrefix(text, MAX_SUGGESTIONS);
+        if (books.empty()) {
+          books = hash_table->FindSimilar(text, SUGGESTION_TYPOS);
+          if (books.size() > MAX_SUGGESTIONS) books.resize(MAX_SUGGESTIONS);
+          if (!books.empty()) std::cout << YELLOW << "No title starts with that text. Did you mean:" << RESET << std::endl;
+        }
+        if (books.empty()) {
+          std::cout << RED << "No title looks like that text" << RESET << std::endl;
+          break;
+        }
+        std::cout << GREEN;
+        for (const Book* book : books) std::cout << book->GetName() << ", " << book->GetAuthor() << std::endl;
+        std::cout << RESET;
+        break;
+      }
       default:
         std::cout << RED << "Incorrect option" << RESET << std::endl;
         break;
     }
   }
-}
\ No newline at end of file
+  if (!WaitForCompaction()) std::cout << RED << "Error saving the data" << RESET << std::endl;
+}
+/** @brief Runs the commands of a script on the table, without the menu. Every
+ *         command is a line with its arguments separated by '|', and writes
+ *         one line with its result:
+ *           insert <name> | <author> | <price>  -> ok | full
+ *           search <name> | <author>            -> found <block> | missing
+ *           delete <name> | <author>            -> ok | missing
+ *           reserve <name> | <author> | <person> -> ok <start date> <return date> | missing
+ *           save                                -> ok | error, the changes made since the last save
+ *           stats                               -> <counter>=<value> ...
+ *           print [<first> | <last>] [| nonempty] -> the blocks from first to last, one per line
+ *           mode <0 | 1 | 2>                    -> ok, searches by name, author or both from then on
+ *           find <name> [| <author>]            -> <count> [| <name>, <author>] ..., the field not searched may be empty
+ *           prefix <text> [| <limit>]           -> <count> [| <name>, <author>] ..., in the order of the names
+ *           similar <text> [| <typos>]          -> <count> [| <name>, <author>] ..., the closest ones first
+ *         Empty lines and lines that start with '#' are skipped.
+ *  @param[in] hash_table. The table.
+ *  @param[in] in. The commands.
+ *  @param[in] out. The output stream of the results.
+ *  @return The number of commands that failed.
+ */
+int RunBatch(Table<Book>* hash_table, std::istream& in, std::ostream& out) {
+  int errors = 0;
+  std::string line;
+  for (int line_number = 1; std::getline(in, line); ++line_number) {
+    std::string_view rest = TrimView(line);
+    if (rest.find_first_not_of(' ') == std::string_view::npos || rest.front() == '#') continue;
+    std::string_view command = rest.substr(0, rest.find(' '));
+    rest.remove_prefix(command.size());
+    std::vector<std::string_view> args;
+    while (!rest.empty()) {
+      std::string_view field = TrimView(NextField(rest, '|'));
+      // A blank field, as the one before the bar of "print | nonempty", is no argument
+      if (field.find_first_not_of(' ') != std::string_view::npos) args.push_back(field);
+    }
+    auto check = [&](size_t count) {
+      if (args.size() == count) return true;
+      out << command << " error: line " << line_number << " needs " << count << " arguments\n";
+      ++errors;
+      return false;
+    };
+    if (command == "insert") {
+      if (!check(3)) continue;
+      double price;
+      if (!ParsePrice(args[2], price)) {
+        out << "insert error: line " << line_number << " has an invalid price\n";
+        ++errors;
+        continue;
+      }
+      Book book(args[0], args[1], price, SEARCHMODE);
+      bool inserted = hash_table->Insert(book);
+      if (inserted) JOURNAL.LogInsert(book);
+      out << "insert " << (inserted ? "ok" : "full") << "\n";
+    }
+    else if (command == "search") {
+      if (!check(2)) continue;
+      int index;
+      if (hash_table->Find(BookKey(args[0], args[1], SEARCHMODE), index) != nullptr) out << "search found " << index << "\n";
+      else                                                                       out << "search missing\n";
+    }
+    else if (command == "delete") {
+      if (!check(2)) continue;
+      bool deleted = hash_table->Delete(BookKey(args[0], args[1], SEARCHMODE));
+      if (deleted) JOURNAL.LogDelete(args[0], args[1]);
+      out << "delete " << (deleted ? "ok" : "missing") << "\n";
+    }
+    else if (command == "reserve") {
+      if (!check(3)) continue;
+      int index;
+      Book* book = hash_table->Find(BookKey(args[0], args[1], SEARCHMODE), index);
+      if (book == nullptr) {
+        out << "reserve missing\n";
+        continue;
+      }
+      Reservation reservation = book->Reserve(std::string(args[2]));
+      JOURNAL.LogReservation(book->GetName(), book->GetAuthor(), reservation);
+      out << "reserve ok " << reservation.start_date << " " << reservation.return_date << "\n";
+    }
+    else if (command == "save") {
+      if (!check(0)) continue;
+      out << "save " << (SaveDatabase(hash_table) ? "ok" : "error") << "\n";
+    }
+    else if (command == "stats") {
+      if (!check(0)) continue;
+      const TableStats& stats = hash_table->Stats();
+      out << "stats size=" << hash_table->GetSize() << " blocks=" << hash_table->GetTableSize() << " inserts=" << stats.inserts
+          << " hits=" << stats.hits << " misses=" << stats.misses << " probes=" << stats.probes << " max_probe=" << stats.max_probe
+          << " full_blocks=" << stats.full_blocks << " exhausted=" << stats.exhausted << "\n";
+    }
+    else if (command == "mode") {
+      if (!check(1)) continue;
+      if (args[0] != "0" && args[0] != "1" && args[0] != "2") {
+        out << "mode error: line " << line_number << " has an invalid search mode\n";
+        ++errors;
+        continue;
+      }
+      hash_table->SetSearchMode(args[0][0] - '0');
+      out << "mode ok\n";
+    }
+    else if (command == "find") {
+      // A name searched alone needs no author
+      if (args.size() == 1) args.emplace_back();
+      if (!check(2)) continue;
+      std::vector<Book*> books = hash_table->FindAll(args[0], args[1]);
+      out << "find " << books.size();
+      for (const Book* book : books) out << " | " << book->GetName() << ", " << book->GetAuthor();
+      out << "\n";
+    }
+    else if (command == "prefix" || command == "similar") {
+      // The limit of the titles found, or the typos allowed, is optional
+      unsigned bound = command == "prefix" ? MAX_SUGGESTIONS : SUGGESTION_TYPOS;
+      if (args.size() == 2 && std::from_chars(args[1].data(), args[1].data() + args[1].size(), bound).ec != std::errc()) {
+        out << command << " error: line " << line_number << " has an invalid number\n";
+        ++errors;
+        continue;
+      }
+      if (args.size() == 2) args.pop_back();
+      if (!check(1)) continue;
+      std::vector<Book*> books = command == "prefix" ? hash_table->FindByPrefix(args[0], bound) : hash_table->FindSimilar(args[0], bound);
+      out << command << " " << books.size();
+      for (const Book* book : books) out << " | " << book->GetName() << ", " << book->GetAuthor();
+      out << "\n";
+    }
+    else if (command == "print") {
+      WriteOptions options;
+      options.non_empty_only = !args.empty() && args.back() == "nonempty";
+      if (options.non_empty_only) args.pop_back();
+      if (args.size() == 2) {
+        unsigned* bounds[] = {&options.first_block, &options.last_block};
+        bool valid = true;
+        for (int i = 0; i < 2; ++i) {
+          valid = valid && std::from_chars(args[i].data(), args[i].data() + args[i].size(), *bounds[i]).ec == std::errc();
+        }
+        if (!valid) {
+          out << "print error: line " << line_number << " has an invalid block\n";
+          ++errors;
+          continue;
+        }
+        // The last block is included in the range
+        if (options.last_block < UINT_MAX) ++options.last_block;
+      }
+      else if (!check(0)) continue;
+      hash_table->Write(out, options);
+    }
+    else {
+      out << "error: line " << line_number << " has an unknown command " << command << "\n";
+      ++errors;
+    }
+  }
+  if (!WaitForCompaction()) {
+    out << "save error: the database couldn't be written\n";
+    ++errors;
+  }
+  out.flush();
+  return errors;
+}